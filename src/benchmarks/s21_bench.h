@@ -0,0 +1,34 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_BENCHMARKS_S21_BENCH_H_
+#define CPP2_S21_CONTAINERS_1_SRC_BENCHMARKS_S21_BENCH_H_
+
+#include <chrono>
+#include <cstdio>
+
+namespace s21 {
+namespace bench {
+// Wall-clock time of one call of fn in milliseconds.
+template <class Fn>
+double TimeMs(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  std::chrono::duration<double, std::milli> took =
+      std::chrono::steady_clock::now() - start;
+  return took.count();
+}
+
+// Prints a run of n operations that took ms in all, and the cost of one.
+inline void Report(const char *name, int n, double ms) {
+  std::printf("%-28s n=%-8d %9.2f ms %7.1f ns/op\n", name, n, ms,
+              ms * 1e6 / n);
+}
+
+// The same with the variant measured, such as a key type or a policy, in
+// a column of its own.
+inline void Report(const char *name, const char *variant, int n, double ms) {
+  std::printf("%-24s %-18s n=%-8d %9.2f ms %7.1f ns/op\n", name, variant, n,
+              ms, ms * 1e6 / n);
+}
+}  // namespace bench
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_BENCHMARKS_S21_BENCH_H_
@@ -0,0 +1,73 @@
+// Read throughput of a shared map by reader threads: a mutex around
+// s21::Map against the lock-free readers of s21::ConcurrentMap. One more
+// thread keeps writing meanwhile.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../s21_concurrent.h"
+
+namespace {
+constexpr int kKeys = 100000;
+constexpr int kReadsPerThread = 200000;
+
+struct LockedMap {
+  bool contains(int key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return map.contains(key);
+  }
+
+  void insert_or_assign(int key, int value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    map.insert_or_assign(key, value);
+  }
+
+  mutable std::mutex mutex;
+  s21::Map<int, int> map;
+};
+
+template <class Map>
+void Run(const char *name, Map &map, int threads) {
+  std::atomic<bool> done{false};
+  std::thread writer([&map, &done] {
+    for (int i = 0; !done; i = (i + 7919) % kKeys) map.insert_or_assign(i, i);
+  });
+  std::atomic<long> found{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> readers;
+  for (int t = 0; t < threads; ++t) {
+    readers.emplace_back([&map, &found, t] {
+      long hits = 0;
+      for (int i = 0; i < kReadsPerThread; ++i) {
+        hits += map.contains((i * 31 + t * 1009) % (2 * kKeys));
+      }
+      found += hits;
+    });
+  }
+  for (auto &reader : readers) reader.join();
+  std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+  done = true;
+  writer.join();
+  std::printf("%-20s threads=%-3d %8.2f Mreads/s\n", name, threads,
+              threads * kReadsPerThread / took.count() / 1e6);
+  if (found == 0) std::puts("lookup failed");
+}
+}  // namespace
+
+int main() {
+  LockedMap locked;
+  s21::ConcurrentMap<int, int> concurrent;
+  concurrent.update([](auto &map) {
+    for (int i = 0; i < kKeys; ++i) map.insert(i, i);
+  });
+  for (int i = 0; i < kKeys; ++i) locked.map.insert(i, i);
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  for (int threads : {1, 2, 4, 8}) {
+    Run("mutex + s21::Map", locked, threads);
+    Run("s21::ConcurrentMap", concurrent, threads);
+  }
+  return 0;
+}
@@ -0,0 +1,35 @@
+// Ascending-key ingest: plain insert against insert with end() as the hint.
+#include <set>
+
+#include "../s21_map/s21_map.h"
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+using s21::bench::Report;
+using s21::bench::TimeMs;
+
+int main() {
+  for (int n : {10000, 100000, 1000000}) {
+    Report("s21::Set insert", n, TimeMs([n] {
+             s21::Set<int> set;
+             for (int i = 0; i < n; ++i) set.insert(i);
+           }));
+    Report("s21::Set insert(end())", n, TimeMs([n] {
+             s21::Set<int> set;
+             for (int i = 0; i < n; ++i) set.insert(set.end(), i);
+           }));
+    Report("std::set insert(end())", n, TimeMs([n] {
+             std::set<int> set;
+             for (int i = 0; i < n; ++i) set.insert(set.end(), i);
+           }));
+    Report("s21::Map insert", n, TimeMs([n] {
+             s21::Map<int, int> map;
+             for (int i = 0; i < n; ++i) map.insert(i, i);
+           }));
+    Report("s21::Map try_emplace(end())", n, TimeMs([n] {
+             s21::Map<int, int> map;
+             for (int i = 0; i < n; ++i) map.try_emplace(map.end(), i, i);
+           }));
+  }
+  return 0;
+}
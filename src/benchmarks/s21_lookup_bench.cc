@@ -0,0 +1,42 @@
+// Random lookups in a large set: red-black tree, B+ tree backend and the
+// frozen Eytzinger layout.
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::Report;
+using s21::bench::TimeMs;
+
+// Builds the set from keys, then looks up every key in a shuffled order.
+template <class Set>
+void RunLookups(const char *name, const std::vector<int> &keys,
+                const std::vector<int> &probes) {
+  Set set(keys.begin(), keys.end());
+  long found = 0;
+  double ms = TimeMs([&] {
+    for (int key : probes) found += set.find(key) != set.end();
+  });
+  Report(name, static_cast<int>(probes.size()), ms);
+  if (found != static_cast<long>(probes.size())) std::puts("lookup failed");
+}
+}  // namespace
+
+int main() {
+  std::mt19937 rng(42);
+  for (int n : {100000, 1000000}) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i * 3;
+    std::vector<int> probes = keys;
+    std::shuffle(probes.begin(), probes.end(), rng);
+    RunLookups<s21::Set<int>>("s21::Set find", keys, probes);
+    RunLookups<s21::BTreeSet<int>>("s21::BTreeSet find", keys, probes);
+    RunLookups<s21::FrozenSet<int>>("s21::FrozenSet find", keys, probes);
+    RunLookups<std::set<int>>("std::set find", keys, probes);
+  }
+  return 0;
+}
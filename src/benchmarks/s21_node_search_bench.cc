@@ -0,0 +1,56 @@
+// Random lookups by key type: BinaryTree::FindNode against B+ tree nodes
+// searched by binary search and by SIMD compares.
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::Report;
+using s21::bench::TimeMs;
+
+template <class T, class NodeSearch>
+using SearchSet =
+    s21::Set<T, std::less<T>, std::allocator<T>,
+             s21::BPlusTree<T, std::less<T>, std::allocator<T>, 256,
+                            NodeSearch>>;
+
+template <class Set, class T>
+void RunLookups(const char *name, const char *type, const std::vector<T> &keys,
+                const std::vector<T> &probes) {
+  Set set(keys.begin(), keys.end());
+  long found = 0;
+  double ms = TimeMs([&] {
+    for (T key : probes) found += set.find(key) != set.end();
+  });
+  Report(name, type, static_cast<int>(probes.size()), ms);
+  if (found != static_cast<long>(probes.size())) std::puts("lookup failed");
+}
+
+template <class T>
+void RunType(const char *type, int n) {
+  std::mt19937_64 rng(42);
+  std::vector<T> keys(n);
+  for (int i = 0; i < n; ++i) keys[i] = static_cast<T>(i) * static_cast<T>(3);
+  std::vector<T> probes = keys;
+  std::shuffle(probes.begin(), probes.end(), rng);
+  RunLookups<s21::Set<T>>("BinaryTree::FindNode", type, keys, probes);
+  RunLookups<SearchSet<T, s21::BinaryNodeSearch>>("BPlusTree binary", type,
+                                                  keys, probes);
+  RunLookups<SearchSet<T, s21::SimdNodeSearch>>("BPlusTree simd", type, keys,
+                                                probes);
+}
+}  // namespace
+
+int main() {
+  for (int n : {100000, 1000000}) {
+    RunType<int32_t>("int32", n);
+    RunType<int64_t>("int64", n);
+    RunType<uint64_t>("uint64", n);
+    RunType<double>("double", n);
+  }
+  return 0;
+}
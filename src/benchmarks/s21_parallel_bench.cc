@@ -0,0 +1,53 @@
+// Scaling of the Parallel bulk operations of s21::Set: construction from a
+// sorted vector, union, intersection, difference and merge, on 1 to 16
+// threads. The element count can be given as the first argument; the
+// speedup is bounded by the hardware threads printed first.
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::TimeMs;
+
+std::vector<int> Multiples(int step, int count) {
+  std::vector<int> values(count);
+  for (int i = 0; i < count; ++i) values[i] = i * step;
+  return values;
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  int count = argc > 1 ? std::atoi(argv[1]) : 2000000;
+  std::printf("hardware threads: %u, elements: %d\n",
+              std::thread::hardware_concurrency(), count);
+  std::vector<int> evens = Multiples(2, count);
+  std::vector<int> triples = Multiples(3, count);
+  std::printf("%-8s %10s %10s %10s %10s %10s\n", "threads", "build",
+              "union", "intersect", "difference", "merge");
+  for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+    s21::Parallel policy(threads);
+    s21::Set<int> lhs;
+    s21::Set<int> rhs(policy, triples.begin(), triples.end());
+    size_t size = 0;
+    double build = TimeMs([&] {
+      lhs = s21::Set<int>(policy, evens.begin(), evens.end());
+    });
+    double uni = TimeMs([&] { size += lhs.set_union(rhs, policy).size(); });
+    double inter =
+        TimeMs([&] { size += lhs.set_intersection(rhs, policy).size(); });
+    double diff =
+        TimeMs([&] { size += lhs.set_difference(rhs, policy).size(); });
+    double merge = TimeMs([&] { lhs.merge(rhs, policy); });
+    std::printf("%-8u %8.1f ms %7.1f ms %7.1f ms %7.1f ms %7.1f ms\n",
+                threads, build, uni, inter, diff, merge);
+    if (size == 0 || lhs.size() + rhs.size() != 2u * count) {
+      std::puts("wrong result");
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,55 @@
+// BinaryTree lookups and full scans by prefetch policy, on a tree small
+// enough for the caches and on one well past the last-level cache.
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::Report;
+using s21::bench::TimeMs;
+
+template <class Prefetch>
+using PrefetchSet = s21::Set<
+    int, std::less<int>, std::allocator<int>,
+    s21::BinaryTree<int, std::less<int>, std::allocator<int>, false,
+                    Prefetch>>;
+
+// Keys go in shuffled, so neighbours in the tree are scattered in memory
+// as in a long-lived tree.
+template <class Prefetch>
+void Run(const char *policy, const std::vector<int> &keys,
+         const std::vector<int> &probes) {
+  PrefetchSet<Prefetch> set;
+  for (int key : keys) set.insert(key);
+  long found = 0;
+  double ms = TimeMs([&] {
+    for (int key : probes) found += set.contains(key);
+  });
+  Report("find", policy, static_cast<int>(probes.size()), ms);
+  long sum = 0;
+  ms = TimeMs([&] {
+    for (int key : set) sum += key;
+  });
+  Report("scan", policy, static_cast<int>(set.size()), ms);
+  if (found != static_cast<long>(probes.size()) || sum == 0) {
+    std::puts("lookup failed");
+  }
+}
+}  // namespace
+
+int main() {
+  std::mt19937 rng(42);
+  for (int n : {100000, 4000000}) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i * 3 + 1;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<int> probes(keys.begin(), keys.begin() + n / 10);
+    std::shuffle(probes.begin(), probes.end(), rng);
+    Run<s21::NoPrefetch>("NoPrefetch", keys, probes);
+    Run<s21::PrefetchChildren>("PrefetchChildren", keys, probes);
+  }
+  return 0;
+}
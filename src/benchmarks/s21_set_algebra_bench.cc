@@ -0,0 +1,52 @@
+// Intersection and difference of two sets: iterating one and calling
+// contains() on the other and inserting the hits, against the one-pass
+// set_intersection and set_difference, for equal and lopsided sizes.
+#include <cstdio>
+
+#include "../s21_set/s21_set.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::TimeMs;
+
+void Report(const char *name, int small, int large, double ms, size_t size) {
+  std::printf("%-26s %8d x %-8d %9.2f ms  size=%zu\n", name, small, large, ms,
+              size);
+}
+
+s21::Set<int> Multiples(int step, int count) {
+  s21::Set<int> set;
+  for (int i = 0; i < count; ++i) set.insert(set.end(), i * step);
+  return set;
+}
+}  // namespace
+
+int main() {
+  const int kLarge = 1000000;
+  for (int small : {1000, 100000, kLarge}) {
+    s21::Set<int> lhs = Multiples(kLarge / small * 3, small);
+    s21::Set<int> rhs = Multiples(2, kLarge);
+    size_t size = 0;
+    double ms = TimeMs([&] {
+      s21::Set<int> result;
+      for (int key : lhs) {
+        if (rhs.contains(key)) result.insert(key);
+      }
+      size = result.size();
+    });
+    Report("contains() + insert", small, kLarge, ms, size);
+    ms = TimeMs([&] { size = lhs.set_intersection(rhs).size(); });
+    Report("set_intersection", small, kLarge, ms, size);
+    ms = TimeMs([&] {
+      s21::Set<int> result;
+      for (int key : lhs) {
+        if (!rhs.contains(key)) result.insert(key);
+      }
+      size = result.size();
+    });
+    Report("!contains() + insert", small, kLarge, ms, size);
+    ms = TimeMs([&] { size = lhs.set_difference(rhs).size(); });
+    Report("set_difference", small, kLarge, ms, size);
+  }
+  return 0;
+}
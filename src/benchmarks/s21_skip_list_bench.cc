@@ -0,0 +1,99 @@
+// Mixed lookups, inserts and erases on a shared set: a mutex around
+// s21::Set (red-black tree) against the lock-free s21::SkipListSet. Every
+// thread reads all keys but only writes its own, so that no two threads
+// erase the same element.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../s21_set/s21_set.h"
+
+namespace {
+constexpr int kKeys = 100000;
+constexpr int kOpsPerThread = 200000;
+
+struct LockedSet {
+  bool contains(int key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return set.contains(key);
+  }
+
+  void insert(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    set.insert(key);
+  }
+
+  void erase(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = set.find(key);
+    if (iter != set.end()) set.erase(iter);
+  }
+
+  mutable std::mutex mutex;
+  s21::Set<int> set;
+};
+
+struct LockFreeSet {
+  bool contains(int key) const { return set.contains(key); }
+
+  void insert(int key) { set.insert(key); }
+
+  void erase(int key) {
+    auto iter = set.find(key);
+    if (iter != set.end()) set.erase(iter);
+  }
+
+  s21::SkipListSet<int> set;
+};
+
+// Half of the operations are lookups, a quarter inserts and a quarter
+// erases, so the size stays about the same.
+template <class Set>
+void Run(const char *name, int threads) {
+  Set set;
+  for (int i = 0; i < kKeys; i += 2) set.insert(i);
+  std::atomic<long> found{0};
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&set, &found, threads, t] {
+      long hits = 0;
+      unsigned state = 2463534242u + t;
+      for (int i = 0; i < kOpsPerThread; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int key = static_cast<int>(state % kKeys);
+        if (i % 2 == 0) {
+          hits += set.contains(key);
+        } else {
+          key -= key % threads - t;
+          if (i % 4 == 1) {
+            set.insert(key);
+          } else {
+            set.erase(key);
+          }
+        }
+      }
+      found += hits;
+    });
+  }
+  for (auto &worker : workers) worker.join();
+  std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+  std::printf("%-20s threads=%-3d %8.2f Mops/s\n", name, threads,
+              threads * kOpsPerThread / took.count() / 1e6);
+  if (found == 0) std::puts("lookup failed");
+}
+}  // namespace
+
+int main() {
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  for (int threads : {1, 2, 4, 8}) {
+    Run<LockedSet>("mutex + s21::Set", threads);
+    Run<LockFreeSet>("s21::SkipListSet", threads);
+  }
+  return 0;
+}
@@ -0,0 +1,44 @@
+// Taking a snapshot of a map under updates: a deep copy of the red-black
+// tree against the shared nodes of the persistent tree.
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../s21_map/s21_map.h"
+#include "s21_bench.h"
+
+namespace {
+using s21::bench::TimeMs;
+
+void Report(const char *name, int n, int ops, double ms) {
+  std::printf("%-20s n=%-8d %9.2f ms %9.1f us/round\n", name, n, ms,
+              ms * 1e3 / ops);
+}
+
+// Every round updates a few keys and keeps a snapshot, the last few of
+// which stay alive.
+template <class Map>
+void Run(const char *name, int n) {
+  std::mt19937 rng(42);
+  Map map;
+  for (int i = 0; i < n; ++i) map.insert(i, i);
+  constexpr int kRounds = 50;
+  constexpr int kUpdates = 16;
+  std::vector<Map> kept(4);
+  double ms = TimeMs([&] {
+    for (int round = 0; round < kRounds; ++round) {
+      for (int i = 0; i < kUpdates; ++i) map.insert_or_assign(rng() % n, i);
+      kept[round % kept.size()] = map.snapshot();
+    }
+  });
+  Report(name, n, kRounds, ms);
+}
+}  // namespace
+
+int main() {
+  for (int n : {10000, 300000}) {
+    Run<s21::Map<int, int>>("s21::Map", n);
+    Run<s21::PersistentMap<int, int>>("s21::PersistentMap", n);
+  }
+  return 0;
+}
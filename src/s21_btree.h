@@ -0,0 +1,1071 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_BTREE_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_BTREE_H_
+
+#include "s21_node_search.h"
+#include "s21_tree.h"
+
+namespace s21 {
+// B+ tree with the interface of BinaryTree, usable as the Container of Set,
+// Multiset and Map. Values live in wide leaves of about NodeBytes bytes,
+// aligned to a cache line and linked in order for scans; inner nodes only
+// hold separator keys, so a lookup reads one node per level of a tree a
+// few levels deep. Inserts and erases move values between slots and
+// invalidate iterators. A node handle owns the extracted value in a node
+// of its own. The order statistics of BinaryTree are not available.
+// NodeSearch finds the slot of a key within a node, see s21_node_search.h.
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>, size_t NodeBytes = 256,
+          class NodeSearch = SimdNodeSearch>
+class BPlusTree : private EmptyBaseHolder<Compare, 0>,
+                  private EmptyBaseHolder<Allocator, 1> {
+ public:
+  using key_type = typename KeyOfValue<K, Compare>::type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using value_type = K;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = size_t;
+  using node_type = NodeHandle<K, TreeNodeAllocator<K, Allocator>>;
+
+ private:
+  struct Inner;
+
+  struct NodeHeader {
+    Inner *parent = nullptr;
+    size_type count = 0;
+    bool is_leaf = true;
+  };
+
+  // Leaves form a ring closed through the head kept in the tree, which
+  // plays the part of the fake node: end() points at it.
+  struct LeafLinks {
+    LeafLinks *prev = this;
+    LeafLinks *next = this;
+  };
+
+  static constexpr size_type kLineBytes = 64;
+  static constexpr size_type kLeafHeader =
+      sizeof(NodeHeader) + sizeof(LeafLinks);
+  static constexpr size_type kInnerHeader =
+      sizeof(NodeHeader) + sizeof(NodeHeader *);
+  static constexpr size_type kLeafSlots =
+      NodeBytes >= kLeafHeader + 4 * sizeof(K)
+          ? (NodeBytes - kLeafHeader) / sizeof(K)
+          : 4;
+  static constexpr size_type kInnerSlots =
+      NodeBytes >= kInnerHeader + 4 * (sizeof(key_type) + sizeof(void *))
+          ? (NodeBytes - kInnerHeader) / (sizeof(key_type) + sizeof(void *))
+          : 4;
+  static constexpr size_type kLeafMin = kLeafSlots / 2;
+  static constexpr size_type kInnerMin = kInnerSlots / 2;
+
+  struct alignas(kLineBytes) Leaf : NodeHeader, LeafLinks {
+    alignas(K) unsigned char slots[kLeafSlots * sizeof(K)];
+
+    K *value(size_type i) { return reinterpret_cast<K *>(slots) + i; }
+  };
+
+  // count keys separate count + 1 children: everything under child i is
+  // not greater than key i, everything under child i + 1 not less.
+  struct alignas(kLineBytes) Inner : NodeHeader {
+    NodeHeader *children[kInnerSlots + 1];
+    alignas(key_type) unsigned char slots[kInnerSlots * sizeof(key_type)];
+
+    Inner() { this->is_leaf = false; }
+
+    key_type *key(size_type i) {
+      return reinterpret_cast<key_type *>(slots) + i;
+    }
+  };
+
+ public:
+  // A leaf and a slot in it; end() is slot 0 of the head.
+  template <bool IsConst>
+  class LeafIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<IsConst || std::is_same_v<key_type, K>, const K &,
+                           K &>;
+    using pointer = std::remove_reference_t<reference> *;
+
+    LeafIterator() = default;
+    LeafIterator(LeafLinks *leaf, size_type index)
+        : leaf_(leaf), index_(index) {}
+
+    template <bool C = IsConst, class = std::enable_if_t<C>>
+    LeafIterator(const LeafIterator<false> &other)
+        : leaf_(other.leaf_), index_(other.index_) {}
+
+    reference operator*() const {
+      return *static_cast<Leaf *>(leaf_)->value(index_);
+    }
+    pointer operator->() const { return &**this; }
+
+    LeafIterator &operator++() {
+      if (++index_ == static_cast<Leaf *>(leaf_)->count) {
+        leaf_ = leaf_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    LeafIterator &operator--() {
+      if (index_ == 0) {
+        leaf_ = leaf_->prev;
+        index_ = static_cast<Leaf *>(leaf_)->count;
+      }
+      --index_;
+      return *this;
+    }
+
+    LeafIterator operator++(int) {
+      LeafIterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    LeafIterator operator--(int) {
+      LeafIterator prev = *this;
+      --*this;
+      return prev;
+    }
+
+    bool operator==(const LeafIterator &other) const {
+      return leaf_ == other.leaf_ && index_ == other.index_;
+    }
+
+    bool operator!=(const LeafIterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    LeafLinks *leaf_ = nullptr;
+    size_type index_ = 0;
+
+    template <bool>
+    friend class LeafIterator;
+    friend class BPlusTree;
+  };
+
+  using Iterator = LeafIterator<false>;
+  using ConstIterator = LeafIterator<true>;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+  using insert_return_type = InsertReturnType<iterator, node_type>;
+
+  BPlusTree() {}
+
+  explicit BPlusTree(const Compare &comp, const Allocator &alloc = Allocator())
+      : CompareBase(comp), AllocatorBase(alloc) {}
+
+  explicit BPlusTree(const Allocator &alloc) : BPlusTree(Compare(), alloc) {}
+
+  BPlusTree(std::initializer_list<value_type> const &items) : BPlusTree() {
+    assign_sorted(items.begin(), items.end());
+  }
+
+  BPlusTree(const BPlusTree &other)
+      : BPlusTree(other.key_comp(),
+                  std::allocator_traits<Allocator>::
+                      select_on_container_copy_construction(
+                          other.get_allocator())) {
+    std::vector<K *> values;
+    values.reserve(other.size());
+    for (const K &value : other) values.push_back(const_cast<K *>(&value));
+    BuildSorted<false>(values);
+  }
+
+  BPlusTree(BPlusTree &&other) noexcept
+      : BPlusTree(other.key_comp(), other.get_allocator()) {
+    swap(other);
+  }
+
+  ~BPlusTree() { clear(); }
+
+  BPlusTree &operator=(BPlusTree &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  iterator begin() { return iterator(head_.next, 0); }
+  iterator end() { return iterator(&head_, 0); }
+  const_iterator begin() const { return const_iterator(head_.next, 0); }
+  const_iterator end() const { return const_iterator(Head(), 0); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(K) / 2;
+  }
+
+  void clear() {
+    FreeNodes(root_);
+    root_ = nullptr;
+    head_.prev = head_.next = &head_;
+    size_ = 0;
+  }
+
+  void swap(BPlusTree &other) {
+    std::swap(comp(), other.comp());
+    std::swap(alloc(), other.alloc());
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(head_, other.head_);
+    RelinkHead(&other.head_);
+    other.RelinkHead(&head_);
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return InsertUnique(KeyOf(value), value);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return InsertUnique(KeyOf(value), std::move(value));
+  }
+
+  // The value may be an element of this tree, which the insert can move:
+  // it is copied out first.
+  std::pair<iterator, bool> insert_def(const value_type &value) {
+    return std::make_pair(emplace_def(value), true);
+  }
+
+  // A leaf is found from the root in a few steps, so hints are accepted
+  // for compatibility and otherwise ignored.
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value).first;
+  }
+
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value)).first;
+  }
+
+  iterator insert_def(const_iterator, const value_type &value) {
+    return emplace_def(value);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    using ArgsKey = EmplaceKey<key_type, value_type, std::decay_t<Args>...>;
+    if constexpr (ArgsKey::value) {
+      return InsertUnique(ArgsKey::Get(args...), std::forward<Args>(args)...);
+    } else {
+      value_type value(std::forward<Args>(args)...);
+      return InsertUnique(KeyOf(value), std::move(value));
+    }
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace_key(const key_type &key,
+                                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace_hint(const_iterator, const key_type &key,
+                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  iterator emplace_def(Args &&...args) {
+    value_type value(std::forward<Args>(args)...);
+    return InsertMulti(KeyOf(value), std::move(value));
+  }
+
+  template <class... Args>
+  iterator emplace_hint_def(const_iterator, Args &&...args) {
+    return emplace_def(std::forward<Args>(args)...);
+  }
+
+  // Builds full leaves bottom-up in O(n) when [first, last) is sorted;
+  // otherwise the range is sorted first. Keeps the first of equal values.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    AssignSorted(first, last, true);
+  }
+
+  template <class InputIt>
+  void assign_sorted_def(InputIt first, InputIt last) {
+    AssignSorted(first, last, false);
+  }
+
+  // Rebuilds both trees from one pass over their values, or inserts the
+  // values of other one by one when it is much smaller. Equal elements
+  // already here stay in other.
+  void merge(BPlusTree &other) { MergeValues(other, true); }
+
+  void merge_multiset(BPlusTree &other) { MergeValues(other, false); }
+
+  iterator find(const key_type &key) { return FindPos(key); }
+
+  const_iterator find(const key_type &key) const { return FindPos(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) {
+    return FindPos(key);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const Key &key) const {
+    return FindPos(key);
+  }
+
+  iterator lower_bound(const key_type &key) { return BoundPos(key, false); }
+
+  const_iterator lower_bound(const key_type &key) const {
+    return BoundPos(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) {
+    return BoundPos(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key &key) const {
+    return BoundPos(key, false);
+  }
+
+  iterator upper_bound(const key_type &key) { return BoundPos(key, true); }
+
+  const_iterator upper_bound(const key_type &key) const {
+    return BoundPos(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) {
+    return BoundPos(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key &key) const {
+    return BoundPos(key, true);
+  }
+
+  size_type count(const key_type &key) const { return CountValues(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return CountValues(key);
+  }
+
+  bool contains(const key_type &key) const {
+    return FindPos(key).leaf_ != &head_;
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return FindPos(key).leaf_ != &head_;
+  }
+
+  key_compare key_comp() const { return comp(); }
+
+  allocator_type get_allocator() const { return alloc(); }
+
+  void erase(iterator pos) {
+    if (pos == end()) throw std::out_of_range("List is empty");
+    EraseAt(static_cast<Leaf *>(pos.leaf_), pos.index_);
+  }
+
+  node_type extract(iterator pos) {
+    if (pos == end()) return node_type();
+    NodeAllocator node_alloc(alloc());
+    TreeNode<K> *node = NodeTraits::allocate(node_alloc, 1);
+    try {
+      NodeTraits::construct(
+          node_alloc, node, std::in_place,
+          std::move(*Slot(pos)));
+    } catch (...) {
+      NodeTraits::deallocate(node_alloc, node, 1);
+      throw;
+    }
+    EraseAt(static_cast<Leaf *>(pos.leaf_), pos.index_);
+    return node_type(node, node_alloc);
+  }
+
+  node_type extract(const key_type &key) { return extract(find(key)); }
+
+  insert_return_type insert(node_type &&node) {
+    if (node.empty()) return {end(), false, node_type()};
+    auto result = InsertUnique(KeyOf(node.value()), std::move(node.value()));
+    if (!result.second) return {result.first, false, std::move(node)};
+    node.reset();
+    return {result.first, true, node_type()};
+  }
+
+  iterator insert_def(node_type &&node) {
+    if (node.empty()) return end();
+    iterator pos = InsertMulti(KeyOf(node.value()), std::move(node.value()));
+    node.reset();
+    return pos;
+  }
+
+ private:
+  using CompareBase = EmptyBaseHolder<Compare, 0>;
+  using AllocatorBase = EmptyBaseHolder<Allocator, 1>;
+  using AllocTraits = std::allocator_traits<Allocator>;
+  using LeafAllocator = typename AllocTraits::template rebind_alloc<Leaf>;
+  using InnerAllocator = typename AllocTraits::template rebind_alloc<Inner>;
+  using NodeAllocator = TreeNodeAllocator<K, Allocator>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  const Compare &comp() const { return CompareBase::get(); }
+  Compare &comp() { return CompareBase::get(); }
+  const Allocator &alloc() const { return AllocatorBase::get(); }
+  Allocator &alloc() { return AllocatorBase::get(); }
+
+  static const key_type &KeyOf(const value_type &value) {
+    return KeyOfValue<K, Compare>::Get(value);
+  }
+
+  template <class Lhs, class Rhs>
+  bool Less(const Lhs &lhs, const Rhs &rhs) const {
+    return comp()(lhs, rhs);
+  }
+
+  LeafLinks *Head() const { return const_cast<LeafLinks *>(&head_); }
+
+  static K *Slot(iterator pos) {
+    return static_cast<Leaf *>(pos.leaf_)->value(pos.index_);
+  }
+
+  // After the heads of two trees were swapped, points the end leaves of
+  // the list that came over at this head.
+  void RelinkHead(LeafLinks *old_head) {
+    if (head_.next == old_head) {
+      head_.prev = head_.next = &head_;
+    } else {
+      head_.next->prev = &head_;
+      head_.prev->next = &head_;
+    }
+  }
+
+  template <class T, class... Args>
+  void Construct(T *ptr, Args &&...args) {
+    AllocTraits::construct(alloc(), ptr, std::forward<Args>(args)...);
+  }
+
+  template <class T>
+  void Destroy(T *ptr) {
+    AllocTraits::destroy(alloc(), ptr);
+  }
+
+  template <class T>
+  void Relocate(T *from, T *to) {
+    Construct(to, std::move(*from));
+    Destroy(from);
+  }
+
+  Leaf *NewLeaf() {
+    LeafAllocator leaf_alloc(alloc());
+    Leaf *leaf = std::allocator_traits<LeafAllocator>::allocate(leaf_alloc, 1);
+    return new (leaf) Leaf;
+  }
+
+  Inner *NewInner() {
+    InnerAllocator inner_alloc(alloc());
+    Inner *inner =
+        std::allocator_traits<InnerAllocator>::allocate(inner_alloc, 1);
+    return new (inner) Inner;
+  }
+
+  void DeleteLeaf(Leaf *leaf) {
+    for (size_type i = 0; i < leaf->count; ++i) Destroy(leaf->value(i));
+    leaf->~Leaf();
+    LeafAllocator leaf_alloc(alloc());
+    std::allocator_traits<LeafAllocator>::deallocate(leaf_alloc, leaf, 1);
+  }
+
+  void DeleteInner(Inner *inner) {
+    for (size_type i = 0; i < inner->count; ++i) Destroy(inner->key(i));
+    inner->~Inner();
+    InnerAllocator inner_alloc(alloc());
+    std::allocator_traits<InnerAllocator>::deallocate(inner_alloc, inner, 1);
+  }
+
+  // The tree is only a few levels deep, so recursion is cheap here.
+  void FreeNodes(NodeHeader *node) {
+    if (!node) return;
+    if (node->is_leaf) {
+      DeleteLeaf(static_cast<Leaf *>(node));
+      return;
+    }
+    auto *inner = static_cast<Inner *>(node);
+    for (size_type i = 0; i <= inner->count; ++i) {
+      FreeNodes(inner->children[i]);
+    }
+    DeleteInner(inner);
+  }
+
+  static void LinkLeafAfter(LeafLinks *prev, Leaf *leaf) {
+    leaf->prev = prev;
+    leaf->next = prev->next;
+    prev->next->prev = leaf;
+    prev->next = leaf;
+  }
+
+  static void UnlinkLeaf(Leaf *leaf) {
+    leaf->prev->next = leaf->next;
+    leaf->next->prev = leaf->prev;
+  }
+
+  // Child to descend into: the first whose separator is not less than key,
+  // or, for upper, the first whose separator is greater.
+  template <class Key>
+  size_type Route(Inner *inner, const Key &key, bool upper) const {
+    return NodeSearch::Find(inner->key(0), inner->count, key, comp(), upper);
+  }
+
+  // Set leaves are packed keys too; map leaves are searched by the keys
+  // of their pairs.
+  template <class Key>
+  size_type LeafSlot(Leaf *leaf, const Key &key, bool upper) const {
+    if constexpr (std::is_same_v<K, key_type>) {
+      return NodeSearch::Find(leaf->value(0), leaf->count, key, comp(),
+                              upper);
+    }
+    K *first = leaf->value(0);
+    K *last = leaf->value(leaf->count);
+    if (upper) {
+      return std::upper_bound(first, last, key,
+                              [this](const Key &k, const K &v) {
+                                return Less(k, KeyOf(v));
+                              }) -
+             first;
+    }
+    return std::lower_bound(first, last, key,
+                            [this](const K &v, const Key &k) {
+                              return Less(KeyOf(v), k);
+                            }) -
+           first;
+  }
+
+  template <class Key>
+  iterator BoundPos(const Key &key, bool upper) const {
+    if (!root_) return iterator(Head(), 0);
+    NodeHeader *node = root_;
+    while (!node->is_leaf) {
+      auto *inner = static_cast<Inner *>(node);
+      node = inner->children[Route(inner, key, upper)];
+    }
+    auto *leaf = static_cast<Leaf *>(node);
+    size_type i = LeafSlot(leaf, key, upper);
+    if (i < leaf->count) return iterator(leaf, i);
+    return iterator(leaf->next, 0);
+  }
+
+  template <class Key>
+  iterator FindPos(const Key &key) const {
+    iterator pos = BoundPos(key, false);
+    if (pos.leaf_ != &head_ && Less(key, KeyOf(*pos))) {
+      return iterator(Head(), 0);
+    }
+    return pos;
+  }
+
+  template <class Key>
+  size_type CountValues(const Key &key) const {
+    size_type count = 0;
+    for (iterator it = BoundPos(key, false);
+         it.leaf_ != &head_ && !Less(key, KeyOf(*it)); ++it) {
+      ++count;
+    }
+    return count;
+  }
+
+  // Walks down to the leaf for key, splitting full inner nodes on the way,
+  // so that a leaf split below always finds room in its parent.
+  Leaf *DescendForInsert(const key_type &key, bool upper) {
+    if (!root_) {
+      Leaf *leaf = NewLeaf();
+      LinkLeafAfter(&head_, leaf);
+      root_ = leaf;
+    }
+    if (!root_->is_leaf && root_->count == kInnerSlots) {
+      SplitInner(static_cast<Inner *>(root_));
+    }
+    NodeHeader *node = root_;
+    while (!node->is_leaf) {
+      auto *inner = static_cast<Inner *>(node);
+      size_type i = Route(inner, key, upper);
+      NodeHeader *child = inner->children[i];
+      if (!child->is_leaf && child->count == kInnerSlots) {
+        SplitInner(static_cast<Inner *>(child));
+        const key_type &sep = *inner->key(i);
+        if (upper ? !Less(key, sep) : Less(sep, key)) ++i;
+        child = inner->children[i];
+      }
+      node = child;
+    }
+    return static_cast<Leaf *>(node);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> InsertUnique(const key_type &key,
+                                         Args &&...args) {
+    Leaf *leaf = DescendForInsert(key, false);
+    size_type i = LeafSlot(leaf, key, false);
+    // Separators may be stale after erases, so the equal value can also
+    // open the next leaf.
+    iterator pos = i < leaf->count ? iterator(leaf, i)
+                                   : iterator(leaf->next, 0);
+    if (pos.leaf_ != &head_ && !Less(key, KeyOf(*pos))) {
+      return std::make_pair(pos, false);
+    }
+    return std::make_pair(EmplaceAt(leaf, i, std::forward<Args>(args)...),
+                          true);
+  }
+
+  template <class... Args>
+  iterator InsertMulti(const key_type &key, Args &&...args) {
+    Leaf *leaf = DescendForInsert(key, true);
+    return EmplaceAt(leaf, LeafSlot(leaf, key, true),
+                     std::forward<Args>(args)...);
+  }
+
+  // Builds a value in slot i of leaf. A full leaf is split first; past the
+  // end of the last leaf a new leaf is started instead, so sorted input
+  // fills every leaf. Building the value is the last step that can throw,
+  // and the tree keeps all its values if it does.
+  template <class... Args>
+  iterator EmplaceAt(Leaf *leaf, size_type i, Args &&...args) {
+    if (leaf->count == kLeafSlots) {
+      if (i == kLeafSlots && leaf->next == &head_) {
+        leaf = AppendLeaf(leaf);
+        i = 0;
+      } else {
+        Leaf *right = SplitLeaf(leaf);
+        if (i > leaf->count) {
+          i -= leaf->count;
+          leaf = right;
+        }
+      }
+    }
+    for (size_type j = leaf->count; j > i; --j) {
+      Relocate(leaf->value(j - 1), leaf->value(j));
+    }
+    try {
+      Construct(leaf->value(i), std::forward<Args>(args)...);
+    } catch (...) {
+      for (size_type j = i; j < leaf->count; ++j) {
+        Relocate(leaf->value(j + 1), leaf->value(j));
+      }
+      if (leaf->count == 0) RebalanceLeaf(leaf);
+      throw;
+    }
+    ++leaf->count;
+    ++size_;
+    return iterator(leaf, i);
+  }
+
+  // Adds an empty leaf after the last one, which is full. Its separator is
+  // the last key of leaf, so the new value need not be built yet.
+  Leaf *AppendLeaf(Leaf *leaf) {
+    Leaf *right = NewLeaf();
+    try {
+      InsertChild(leaf, KeyOf(*leaf->value(leaf->count - 1)), right);
+    } catch (...) {
+      DeleteLeaf(right);
+      throw;
+    }
+    LinkLeafAfter(leaf, right);
+    return right;
+  }
+
+  Leaf *SplitLeaf(Leaf *leaf) {
+    Leaf *right = NewLeaf();
+    size_type mid = leaf->count / 2;
+    try {
+      InsertChild(leaf, KeyOf(*leaf->value(mid)), right);
+    } catch (...) {
+      DeleteLeaf(right);
+      throw;
+    }
+    for (size_type j = mid; j < leaf->count; ++j) {
+      Relocate(leaf->value(j), right->value(j - mid));
+    }
+    right->count = leaf->count - mid;
+    leaf->count = mid;
+    LinkLeafAfter(leaf, right);
+    return right;
+  }
+
+  // Moves the upper half of a full inner node to a new sibling and pushes
+  // the middle key up.
+  void SplitInner(Inner *inner) {
+    Inner *right = NewInner();
+    if (!inner->parent) {
+      try {
+        GrowRoot(inner);
+      } catch (...) {
+        DeleteInner(right);
+        throw;
+      }
+    }
+    size_type mid = inner->count / 2;
+    for (size_type j = mid + 1; j < inner->count; ++j) {
+      Relocate(inner->key(j), right->key(j - mid - 1));
+    }
+    for (size_type j = mid + 1; j <= inner->count; ++j) {
+      right->children[j - mid - 1] = inner->children[j];
+      inner->children[j]->parent = right;
+    }
+    right->count = inner->count - mid - 1;
+    key_type up(std::move(*inner->key(mid)));
+    Destroy(inner->key(mid));
+    inner->count = mid;
+    InsertChild(inner, std::move(up), right);
+  }
+
+  // Puts a new root above the old one.
+  void GrowRoot(NodeHeader *top) {
+    Inner *parent = NewInner();
+    parent->children[0] = top;
+    top->parent = parent;
+    root_ = parent;
+  }
+
+  // Adds right after left in their parent, growing a new root above left
+  // if it has none. The parent is known to have room. sep is taken by
+  // value, so only the copy at the call and a new root can throw, and
+  // both come before any change.
+  void InsertChild(NodeHeader *left, key_type sep, NodeHeader *right) {
+    if (!left->parent) GrowRoot(left);
+    Inner *parent = left->parent;
+    size_type pos = ChildIndex(parent, left);
+    for (size_type j = parent->count; j > pos; --j) {
+      Relocate(parent->key(j - 1), parent->key(j));
+      parent->children[j + 1] = parent->children[j];
+    }
+    Construct(parent->key(pos), std::move(sep));
+    parent->children[pos + 1] = right;
+    right->parent = parent;
+    ++parent->count;
+  }
+
+  static size_type ChildIndex(Inner *parent, NodeHeader *child) {
+    size_type i = 0;
+    while (parent->children[i] != child) ++i;
+    return i;
+  }
+
+  void AssignKey(Inner *inner, size_type i, const key_type &key) {
+    key_type copy(key);
+    Destroy(inner->key(i));
+    Construct(inner->key(i), std::move(copy));
+  }
+
+  // Drops key i and child i + 1 of inner.
+  void RemoveChild(Inner *inner, size_type i) {
+    Destroy(inner->key(i));
+    for (size_type j = i + 1; j < inner->count; ++j) {
+      Relocate(inner->key(j), inner->key(j - 1));
+      inner->children[j] = inner->children[j + 1];
+    }
+    --inner->count;
+  }
+
+  void EraseAt(Leaf *leaf, size_type i) {
+    Destroy(leaf->value(i));
+    for (size_type j = i + 1; j < leaf->count; ++j) {
+      Relocate(leaf->value(j), leaf->value(j - 1));
+    }
+    --leaf->count;
+    --size_;
+    RebalanceLeaf(leaf);
+  }
+
+  // Refills a leaf that fell below half from a sibling, or merges the two.
+  void RebalanceLeaf(Leaf *leaf) {
+    if (leaf == root_) {
+      if (leaf->count == 0) {
+        UnlinkLeaf(leaf);
+        DeleteLeaf(leaf);
+        root_ = nullptr;
+      }
+      return;
+    }
+    if (leaf->count >= kLeafMin) return;
+    Inner *parent = leaf->parent;
+    size_type i = ChildIndex(parent, leaf);
+    auto *left = i > 0 ? static_cast<Leaf *>(parent->children[i - 1])
+                       : nullptr;
+    auto *right = i < parent->count
+                      ? static_cast<Leaf *>(parent->children[i + 1])
+                      : nullptr;
+    if (left && left->count > kLeafMin) {
+      for (size_type j = leaf->count; j > 0; --j) {
+        Relocate(leaf->value(j - 1), leaf->value(j));
+      }
+      Relocate(left->value(--left->count), leaf->value(0));
+      ++leaf->count;
+      AssignKey(parent, i - 1, KeyOf(*leaf->value(0)));
+    } else if (right && right->count > kLeafMin) {
+      Relocate(right->value(0), leaf->value(leaf->count++));
+      for (size_type j = 1; j < right->count; ++j) {
+        Relocate(right->value(j), right->value(j - 1));
+      }
+      --right->count;
+      AssignKey(parent, i, KeyOf(*right->value(0)));
+    } else if (left) {
+      MergeLeaves(left, leaf, parent, i - 1);
+    } else {
+      MergeLeaves(leaf, right, parent, i);
+    }
+  }
+
+  void MergeLeaves(Leaf *left, Leaf *right, Inner *parent, size_type sep) {
+    for (size_type j = 0; j < right->count; ++j) {
+      Relocate(right->value(j), left->value(left->count++));
+    }
+    right->count = 0;
+    UnlinkLeaf(right);
+    DeleteLeaf(right);
+    RemoveChild(parent, sep);
+    RebalanceInner(parent);
+  }
+
+  // Same for inner nodes, rotating keys through the parent. An empty root
+  // gives way to its only child.
+  void RebalanceInner(Inner *inner) {
+    if (inner == root_) {
+      if (inner->count == 0) {
+        root_ = inner->children[0];
+        root_->parent = nullptr;
+        DeleteInner(inner);
+      }
+      return;
+    }
+    if (inner->count >= kInnerMin) return;
+    Inner *parent = inner->parent;
+    size_type i = ChildIndex(parent, inner);
+    auto *left = i > 0 ? static_cast<Inner *>(parent->children[i - 1])
+                       : nullptr;
+    auto *right = i < parent->count
+                      ? static_cast<Inner *>(parent->children[i + 1])
+                      : nullptr;
+    if (left && left->count > kInnerMin) {
+      for (size_type j = inner->count; j > 0; --j) {
+        Relocate(inner->key(j - 1), inner->key(j));
+        inner->children[j + 1] = inner->children[j];
+      }
+      inner->children[1] = inner->children[0];
+      Relocate(parent->key(i - 1), inner->key(0));
+      inner->children[0] = left->children[left->count];
+      inner->children[0]->parent = inner;
+      ++inner->count;
+      Relocate(left->key(--left->count), parent->key(i - 1));
+    } else if (right && right->count > kInnerMin) {
+      Relocate(parent->key(i), inner->key(inner->count));
+      inner->children[++inner->count] = right->children[0];
+      right->children[0]->parent = inner;
+      Relocate(right->key(0), parent->key(i));
+      right->children[0] = right->children[1];
+      for (size_type j = 1; j < right->count; ++j) {
+        Relocate(right->key(j), right->key(j - 1));
+        right->children[j] = right->children[j + 1];
+      }
+      --right->count;
+    } else if (left) {
+      MergeInners(left, inner, parent, i - 1);
+    } else {
+      MergeInners(inner, right, parent, i);
+    }
+  }
+
+  void MergeInners(Inner *left, Inner *right, Inner *parent, size_type sep) {
+    Construct(left->key(left->count++), *parent->key(sep));
+    for (size_type j = 0; j <= right->count; ++j) {
+      left->children[left->count + j] = right->children[j];
+      right->children[j]->parent = left;
+    }
+    for (size_type j = 0; j < right->count; ++j) {
+      Relocate(right->key(j), left->key(left->count + j));
+    }
+    left->count += right->count;
+    right->count = 0;
+    DeleteInner(right);
+    RemoveChild(parent, sep);
+    RebalanceInner(parent);
+  }
+
+  // Builds an empty tree from the sorted values pointed at, moving them
+  // if Move is set and copying them otherwise.
+  template <bool Move>
+  void BuildSorted(const std::vector<K *> &values) {
+    BuildNodes(values);
+    try {
+      FillLeaves<Move>(values);
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  // Allocates the leaves and inner nodes that the sorted values pointed at
+  // pack into, and copies the separator keys from them, but takes no
+  // value: FillLeaves does that. Leaves are packed evenly, then each level
+  // of inner nodes is built over the one below. On a throw the tree is
+  // left empty.
+  void BuildNodes(const std::vector<K *> &values) {
+    size_type n = values.size();
+    if (n == 0) return;
+    size_type leaves = (n + kLeafSlots - 1) / kLeafSlots;
+    std::vector<NodeHeader *> level;
+    std::vector<size_type> firsts;
+    std::vector<Inner *> inners;
+    try {
+      level.reserve(leaves);
+      firsts.reserve(leaves);
+      inners.reserve(leaves);
+      for (size_type i = 0, done = 0; i < leaves; ++i) {
+        Leaf *leaf = NewLeaf();
+        LinkLeafAfter(head_.prev, leaf);
+        level.push_back(leaf);
+        firsts.push_back(done);
+        done += (n - done) / (leaves - i);
+      }
+      while (level.size() > 1) {
+        size_type groups = (level.size() + kInnerSlots) / (kInnerSlots + 1);
+        std::vector<NodeHeader *> upper;
+        std::vector<size_type> upper_firsts;
+        for (size_type g = 0, done = 0; g < groups; ++g) {
+          size_type take = (level.size() - done) / (groups - g);
+          Inner *inner = NewInner();
+          inners.push_back(inner);
+          for (size_type c = 0; c < take; ++c) {
+            inner->children[c] = level[done + c];
+            level[done + c]->parent = inner;
+            if (c > 0) {
+              Construct(inner->key(c - 1), KeyOf(*values[firsts[done + c]]));
+              ++inner->count;
+            }
+          }
+          upper.push_back(inner);
+          upper_firsts.push_back(firsts[done]);
+          done += take;
+        }
+        level.swap(upper);
+        firsts.swap(upper_firsts);
+      }
+      root_ = level.front();
+    } catch (...) {
+      for (Inner *inner : inners) DeleteInner(inner);
+      while (head_.next != &head_) {
+        auto *leaf = static_cast<Leaf *>(head_.next);
+        UnlinkLeaf(leaf);
+        DeleteLeaf(leaf);
+      }
+      root_ = nullptr;
+      throw;
+    }
+  }
+
+  // Puts the values into the leaves BuildNodes made for them. If a copy
+  // throws, the values here so far stay and clear() frees them.
+  template <bool Move>
+  void FillLeaves(const std::vector<K *> &values) {
+    size_type n = values.size();
+    size_type leaves = (n + kLeafSlots - 1) / kLeafSlots;
+    LeafLinks *link = head_.next;
+    for (size_type i = 0, done = 0; i < leaves; ++i, link = link->next) {
+      auto *leaf = static_cast<Leaf *>(link);
+      for (size_type last = done + (n - done) / (leaves - i); done < last;
+           ++done, ++leaf->count, ++size_) {
+        if constexpr (Move) {
+          Construct(leaf->value(leaf->count), std::move(*values[done]));
+        } else {
+          Construct(leaf->value(leaf->count), std::as_const(*values[done]));
+        }
+      }
+    }
+  }
+
+  template <class InputIt>
+  void AssignSorted(InputIt first, InputIt last, bool unique) {
+    std::vector<K> values;
+    std::vector<K *> order = SortedOrder(first, last, comp(), unique, values);
+    BPlusTree built(comp(), alloc());
+    built.BuildSorted<true>(order);
+    swap(built);
+  }
+
+  // Both trees are rebuilt: all their nodes are made before any value is
+  // taken, and values are only moved if that cannot throw, so on a throw
+  // both trees keep all their values. A much smaller other is inserted
+  // value by value instead.
+  void MergeValues(BPlusTree &other, bool unique) {
+    if (this == &other || other.empty()) return;
+    if (MergeBySearch(size_, other.size_)) {
+      InsertValues(other, unique);
+      return;
+    }
+    std::vector<K *> merged;
+    std::vector<K *> rest;
+    merged.reserve(size_ + other.size_);
+    iterator mine = begin();
+    for (iterator it = other.begin(); it != other.end(); ++it) {
+      while (mine != end() && !Less(KeyOf(*it), KeyOf(*mine))) {
+        merged.push_back(Slot(mine++));
+      }
+      K *value = Slot(it);
+      if (unique && !merged.empty() && !Less(KeyOf(*merged.back()),
+                                             KeyOf(*value))) {
+        rest.push_back(value);
+      } else {
+        merged.push_back(value);
+      }
+    }
+    for (; mine != end(); ++mine) merged.push_back(Slot(mine));
+    constexpr bool kMove = std::is_nothrow_move_constructible_v<K> ||
+                           !std::is_copy_constructible_v<K>;
+    BPlusTree built(comp(), alloc());
+    BPlusTree left(other.comp(), other.alloc());
+    built.BuildNodes(merged);
+    left.BuildNodes(rest);
+    built.FillLeaves<kMove>(merged);
+    left.FillLeaves<kMove>(rest);
+    swap(built);
+    other.swap(left);
+  }
+
+  // Moves the values of other over one at a time, each erased from other
+  // once it is in, so a throw leaves every value in one of the trees.
+  void InsertValues(BPlusTree &other, bool unique) {
+    iterator it = other.begin();
+    while (it != other.end()) {
+      K &value = *Slot(it);
+      iterator pos;
+      if (unique) {
+        auto result = InsertUnique(KeyOf(value), std::move_if_noexcept(value));
+        if (!result.second) {
+          ++it;
+          continue;
+        }
+        pos = result.first;
+      } else {
+        pos = InsertMulti(KeyOf(value), std::move_if_noexcept(value));
+      }
+      other.EraseAt(static_cast<Leaf *>(it.leaf_), it.index_);
+      it = other.BoundPos(KeyOf(*pos), false);
+    }
+  }
+
+  NodeHeader *root_ = nullptr;
+  LeafLinks head_;
+  size_type size_ = 0;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_BTREE_H_
@@ -0,0 +1,161 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_CONCURRENT_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_CONCURRENT_H_
+
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "s21_epoch.h"
+#include "s21_map/s21_map.h"
+#include "s21_set/s21_set.h"
+
+namespace s21 {
+// Set or map shared by many threads, kept as a published version of a
+// persistent container (PersistentSet or PersistentMap). Readers load the
+// version under an epoch guard and never lock or write shared data, so
+// they scale with the cores. Writers take turns on a mutex: each copies
+// the version in O(1), as the copy shares every node, changes the copy,
+// which copies only the nodes on the changed paths, and publishes it. A
+// replaced version is freed once no reader can still see it.
+template <class Container>
+class ConcurrentTree {
+ public:
+  using container_type = Container;
+  using key_type = typename Container::key_type;
+  using value_type = typename Container::value_type;
+  using size_type = typename Container::size_type;
+
+  ConcurrentTree() : current_(new Container()) {}
+  ConcurrentTree(const ConcurrentTree &) = delete;
+  ConcurrentTree &operator=(const ConcurrentTree &) = delete;
+  ~ConcurrentTree() { delete current_.load(std::memory_order_relaxed); }
+
+  bool empty() const {
+    return Read([](const Container &items) { return items.empty(); });
+  }
+
+  size_type size() const {
+    return Read([](const Container &items) { return items.size(); });
+  }
+
+  bool contains(const key_type &key) const {
+    return Read([&key](const Container &items) {
+      return items.contains(key);
+    });
+  }
+
+  // The current version in O(1); it stays valid and unchanged for as long
+  // as it is kept.
+  Container snapshot() const {
+    return Read([](const Container &items) { return items; });
+  }
+
+  // Calls fn on every element of one version, in order. Writers are not
+  // held up, but the version stays alive until fn returns.
+  template <class Fn>
+  void for_each(Fn fn) const {
+    Read([&fn](const Container &items) {
+      for (const value_type &value : items) fn(value);
+      return true;
+    });
+  }
+
+  // Applies fn to a private copy of the container and publishes the result
+  // as one change: readers see all of it or none.
+  template <class Fn>
+  void update(Fn fn) {
+    Write([&fn](Container &items) {
+      fn(items);
+      return true;
+    });
+  }
+
+  void clear() {
+    Write([](Container &items) {
+      items.clear();
+      return true;
+    });
+  }
+
+  size_type erase(const key_type &key) {
+    return Write([&key](Container &items) {
+      auto iter = items.find(key);
+      if (iter == items.end()) return false;
+      items.erase(iter);
+      return true;
+    });
+  }
+
+ protected:
+  template <class Fn>
+  auto Read(Fn fn) const {
+    EpochDomain::Guard guard(domain_);
+    const Container *items = current_.load(std::memory_order_acquire);
+    return fn(*items);
+  }
+
+  // fn changes the copy and tells whether it changed anything; an
+  // unchanged copy is not published.
+  template <class Fn>
+  bool Write(Fn fn) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    EpochDomain::Guard guard(domain_);
+    Container *current = current_.load(std::memory_order_relaxed);
+    auto next = std::make_unique<Container>(*current);
+    if (!fn(*next)) return false;
+    current_.store(next.release(), std::memory_order_seq_cst);
+    guard.Retire(current);
+    return true;
+  }
+
+ private:
+  mutable EpochDomain domain_;
+  std::mutex write_mutex_;
+  std::atomic<Container *> current_;
+};
+
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class ConcurrentSet
+    : public ConcurrentTree<PersistentSet<Key, Compare, Allocator>> {
+ public:
+  bool insert(const Key &key) {
+    return this->Write([&key](auto &items) {
+      return items.insert(key).second;
+    });
+  }
+};
+
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class ConcurrentMap
+    : public ConcurrentTree<PersistentMap<Key, T, Compare, Allocator>> {
+ public:
+  using mapped_type = T;
+
+  // A copy of the mapped value: the version it lives in may be freed as
+  // soon as the call returns.
+  std::optional<T> get(const Key &key) const {
+    return this->Read([&key](const auto &items) -> std::optional<T> {
+      auto iter = items.find(key);
+      if (iter == items.end()) return std::nullopt;
+      return iter->second;
+    });
+  }
+
+  bool insert(const Key &key, const T &obj) {
+    return this->Write([&](auto &items) {
+      return items.insert(key, obj).second;
+    });
+  }
+
+  void insert_or_assign(const Key &key, const T &obj) {
+    this->Write([&](auto &items) {
+      items.insert_or_assign(key, obj);
+      return true;
+    });
+  }
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_CONCURRENT_H_
@@ -0,0 +1,136 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_EPOCH_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_EPOCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+// Epoch-based reclamation for structures that are read without locks.
+// Every access, read or write, holds a Guard, which announces the epoch it
+// started in. An object unlinked from the structure is handed to
+// Guard::Retire() and freed once every guard that could still reach it has
+// ended. A guard only writes its own slot, so readers do not contend.
+class EpochDomain {
+  struct Retired {
+    void *object;
+    void *context;
+    void (*deleter)(void *, void *);
+    uint64_t epoch;
+  };
+
+  // A slot is taken by one guard at a time; the objects retired under it
+  // stay with the slot until they can be freed. While an old guard holds
+  // them back, collect_at grows so that they are not scanned on every exit.
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> epoch{0};
+    std::vector<Retired> retired;
+    size_t collect_at = kBatch;
+  };
+
+ public:
+  // Guards are meant to be short: a long one holds back every object
+  // retired after it started.
+  class Guard {
+   public:
+    explicit Guard(EpochDomain &domain) : domain_(domain) {
+      thread_local size_t hint =
+          std::hash<std::thread::id>()(std::this_thread::get_id());
+      for (size_t tries = 1;; ++tries, hint = (hint + 1) % kSlots) {
+        Slot &slot = domain.slots_[hint % kSlots];
+        uint64_t free = 0;
+        if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch.compare_exchange_strong(
+                free, domain.epoch_.load(std::memory_order_seq_cst))) {
+          slot_ = &slot;
+          break;
+        }
+        if (tries % kSlots == 0) std::this_thread::yield();
+      }
+      // Loads of the structure must not be ordered before the slot says
+      // that this guard can see it.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+    ~Guard() {
+      if (slot_->retired.size() >= slot_->collect_at) domain_.Collect(slot_);
+      slot_->epoch.store(0, std::memory_order_release);
+    }
+
+    // Frees object once no guard can reach it; it must already be
+    // unreachable for guards that start from now on.
+    template <class T>
+    void Retire(T *object) {
+      Retire(object, nullptr,
+             [](void *ptr, void *) { delete static_cast<T *>(ptr); });
+    }
+
+    // Same for an object that deleter(object, context) frees, such as a
+    // node that goes back to the allocator of its container.
+    void Retire(void *object, void *context,
+                void (*deleter)(void *, void *)) {
+      slot_->retired.push_back(
+          {object, context, deleter,
+           domain_.epoch_.fetch_add(1, std::memory_order_seq_cst)});
+    }
+
+   private:
+    EpochDomain &domain_;
+    Slot *slot_ = nullptr;
+  };
+
+  EpochDomain() = default;
+  EpochDomain(const EpochDomain &) = delete;
+  EpochDomain &operator=(const EpochDomain &) = delete;
+
+  ~EpochDomain() { Flush(); }
+
+  // Frees every retired object at once. No guard may be alive.
+  void Flush() {
+    for (Slot &slot : slots_) {
+      for (Retired &item : slot.retired) {
+        item.deleter(item.object, item.context);
+      }
+      slot.retired.clear();
+    }
+  }
+
+ private:
+  static constexpr size_t kSlots = 128;
+  static constexpr size_t kBatch = 32;
+
+  // Frees the objects of own that were retired before the oldest epoch
+  // announced by other guards. own belongs to a guard that is ending, so
+  // its own epoch does not count.
+  void Collect(Slot *own) {
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (Slot &slot : slots_) {
+      uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+      if (&slot != own && epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+    auto kept = own->retired.begin();
+    for (Retired &item : own->retired) {
+      if (item.epoch < oldest) {
+        item.deleter(item.object, item.context);
+      } else {
+        *kept++ = item;
+      }
+    }
+    own->retired.erase(kept, own->retired.end());
+    own->collect_at = std::max(kBatch, 2 * own->retired.size());
+  }
+
+  // Starts at 1: a slot that holds 0 is free.
+  std::atomic<uint64_t> epoch_{1};
+  Slot slots_[kSlots];
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_EPOCH_H_
@@ -0,0 +1,476 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_FROZEN_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_FROZEN_H_
+
+#include "s21_tree.h"
+
+namespace s21 {
+// Read-only sorted values in one array, laid out in Eytzinger (BFS) order:
+// slot k holds the root of an implicit tree whose children sit in slots 2k
+// and 2k + 1, counting from 1. A search reads slots 1, 2 or 3, 4 to 7 and
+// so on, so the top levels share a few hot cache lines, and it prefetches
+// the slots four levels down while comparing. Index 0 stands for end().
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>>
+class EytzingerTree : private EmptyBaseHolder<Compare, 0>,
+                      private EmptyBaseHolder<Allocator, 1> {
+ public:
+  using key_type = typename KeyOfValue<K, Compare>::type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using value_type = K;
+  using size_type = size_t;
+
+  // Walks the implicit tree in order; values are only reachable as const.
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference = const K &;
+    using pointer = const K *;
+
+    Iterator() = default;
+    Iterator(const K *values, size_type size, size_type index)
+        : values_(values), size_(size), index_(index) {}
+
+    reference operator*() const { return values_[index_ - 1]; }
+    pointer operator->() const { return values_ + index_ - 1; }
+
+    Iterator &operator++() {
+      index_ = Next(index_, size_);
+      return *this;
+    }
+
+    Iterator &operator--() {
+      index_ = Prev(index_, size_);
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    Iterator operator--(int) {
+      Iterator prev = *this;
+      --*this;
+      return prev;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return index_ == other.index_ && values_ == other.values_;
+    }
+
+    bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+   private:
+    const K *values_ = nullptr;
+    size_type size_ = 0;
+    size_type index_ = 0;
+
+    friend class EytzingerTree;
+  };
+
+  using ConstIterator = Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  EytzingerTree() {}
+
+  explicit EytzingerTree(const Compare &comp,
+                         const Allocator &alloc = Allocator())
+      : CompareBase(comp), AllocatorBase(alloc) {}
+
+  EytzingerTree(const EytzingerTree &other)
+      : EytzingerTree(other.key_comp(),
+                      std::allocator_traits<Allocator>::
+                          select_on_container_copy_construction(
+                              other.get_allocator())) {
+    Build(other.size_, [&other](size_type k) -> const K & {
+      return other.values_[k - 1];
+    });
+  }
+
+  EytzingerTree(EytzingerTree &&other) noexcept
+      : EytzingerTree(other.key_comp(), other.get_allocator()) {
+    swap(other);
+  }
+
+  ~EytzingerTree() { clear(); }
+
+  EytzingerTree &operator=(EytzingerTree &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  iterator begin() const { return iterator(values_, size_, First(size_)); }
+  iterator end() const { return iterator(values_, size_, 0); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(K) / 2;
+  }
+
+  void clear() {
+    if (!values_) return;
+    for (size_type i = 0; i < size_; ++i) {
+      Traits::destroy(alloc(), values_ + i);
+    }
+    Traits::deallocate(alloc(), values_, size_);
+    values_ = nullptr;
+    size_ = 0;
+  }
+
+  void swap(EytzingerTree &other) {
+    std::swap(comp(), other.comp());
+    std::swap(alloc(), other.alloc());
+    std::swap(values_, other.values_);
+    std::swap(size_, other.size_);
+  }
+
+  // Replaces the contents with [first, last), sorting it unless it is
+  // sorted already. Keeps the first of equal values.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    std::vector<K> values;
+    std::vector<K *> order = SortedOrder(first, last, comp(), true, values);
+    std::vector<size_type> rank(order.size() + 1);
+    for (size_type k = First(order.size()), r = 0; k != 0;
+         k = Next(k, order.size())) {
+      rank[k] = r++;
+    }
+    EytzingerTree built(comp(), alloc());
+    built.Build(order.size(), [&order, &rank](size_type k) -> K && {
+      return std::move(*order[rank[k]]);
+    });
+    swap(built);
+  }
+
+  iterator find(const key_type &key) const { return At(FindIndex(key)); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) const {
+    return At(FindIndex(key));
+  }
+
+  bool contains(const key_type &key) const { return FindIndex(key) != 0; }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return FindIndex(key) != 0;
+  }
+
+  size_type count(const key_type &key) const { return contains(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return contains(key);
+  }
+
+  iterator lower_bound(const key_type &key) const {
+    return At(BoundIndex(key, false));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) const {
+    return At(BoundIndex(key, false));
+  }
+
+  iterator upper_bound(const key_type &key) const {
+    return At(BoundIndex(key, true));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) const {
+    return At(BoundIndex(key, true));
+  }
+
+  key_compare key_comp() const { return comp(); }
+
+  allocator_type get_allocator() const { return alloc(); }
+
+ private:
+  using CompareBase = EmptyBaseHolder<Compare, 0>;
+  using AllocatorBase = EmptyBaseHolder<Allocator, 1>;
+  using Traits = std::allocator_traits<Allocator>;
+
+  // The descendants of slot k four levels down are the 16 slots from 16k
+  // on, adjacent in memory: a cache line of int keys, fetched while the
+  // next four compares run.
+  static constexpr size_type kPrefetchLevels = 4;
+
+  const Compare &comp() const { return CompareBase::get(); }
+  Compare &comp() { return CompareBase::get(); }
+  const Allocator &alloc() const { return AllocatorBase::get(); }
+  Allocator &alloc() { return AllocatorBase::get(); }
+
+  static const key_type &KeyOf(const value_type &value) {
+    return KeyOfValue<K, Compare>::Get(value);
+  }
+
+  template <class Lhs, class Rhs>
+  bool Less(const Lhs &lhs, const Rhs &rhs) const {
+    return comp()(lhs, rhs);
+  }
+
+  iterator At(size_type k) const { return iterator(values_, size_, k); }
+
+  // Leftmost slot, or 0 when there is none.
+  static size_type First(size_type size) {
+    if (size == 0) return 0;
+    size_type k = 1;
+    while (2 * k <= size) k *= 2;
+    return k;
+  }
+
+  // In-order successor: the leftmost slot of the right subtree, or else
+  // the first ancestor reached from a left child. Dropping the trailing
+  // ones of k and one more bit climbs to that ancestor.
+  static size_type Next(size_type k, size_type size) {
+    if (2 * k + 1 <= size) {
+      k = 2 * k + 1;
+      while (2 * k <= size) k *= 2;
+      return k;
+    }
+    return k >> (CountTrailingZeros(~k) + 1);
+  }
+
+  static size_type Prev(size_type k, size_type size) {
+    if (k == 0) {
+      if (size == 0) return 0;
+      k = 1;
+      while (2 * k + 1 <= size) k = 2 * k + 1;
+      return k;
+    }
+    if (2 * k <= size) {
+      k *= 2;
+      while (2 * k + 1 <= size) k = 2 * k + 1;
+      return k;
+    }
+    return k >> (CountTrailingZeros(k) + 1);
+  }
+
+  static size_type CountTrailingZeros(size_type bits) {
+    return bits == 0 ? std::numeric_limits<size_type>::digits
+                     : static_cast<size_type>(__builtin_ctzll(bits));
+  }
+
+  void Prefetch(size_type k) const {
+    size_type ahead = k << kPrefetchLevels;
+    if (ahead <= size_) __builtin_prefetch(values_ + ahead - 1);
+  }
+
+  // The descent goes right past every slot before the bound, so the bound
+  // is the ancestor where it last went left.
+  template <class Key>
+  size_type BoundIndex(const Key &key, bool upper) const {
+    size_type k = 1;
+    while (k <= size_) {
+      Prefetch(k);
+      const key_type &probe = KeyOf(values_[k - 1]);
+      bool right = upper ? !Less(key, probe) : Less(probe, key);
+      k = 2 * k + right;
+    }
+    return k >> (CountTrailingZeros(~k) + 1);
+  }
+
+  template <class Key>
+  size_type FindIndex(const Key &key) const {
+    size_type k = BoundIndex(key, false);
+    if (k != 0 && Less(key, KeyOf(values_[k - 1]))) return 0;
+    return k;
+  }
+
+  // Fills an empty tree with size values; slot k is built from value(k).
+  template <class Source>
+  void Build(size_type size, Source value) {
+    if (size == 0) return;
+    K *values = Traits::allocate(alloc(), size);
+    size_type built = 0;
+    try {
+      for (; built < size; ++built) {
+        Traits::construct(alloc(), values + built, value(built + 1));
+      }
+    } catch (...) {
+      while (built > 0) Traits::destroy(alloc(), values + --built);
+      Traits::deallocate(alloc(), values, size);
+      throw;
+    }
+    values_ = values;
+    size_ = size;
+  }
+
+  K *values_ = nullptr;
+  size_type size_ = 0;
+};
+
+// Set frozen into an EytzingerTree: built once, then only searched.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+class FrozenSet {
+ public:
+  using tree_type = EytzingerTree<Key, Compare, Allocator>;
+  using key_type = Key;
+  using value_type = Key;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using reference = const value_type &;
+  using const_reference = const value_type &;
+  using iterator = typename tree_type::Iterator;
+  using const_iterator = typename tree_type::ConstIterator;
+  using size_type = std::size_t;
+
+  FrozenSet() {}
+
+  FrozenSet(std::initializer_list<value_type> const &items) {
+    ft_.assign_sorted(items.begin(), items.end());
+  }
+
+  template <class InputIt, class = typename std::iterator_traits<
+                               InputIt>::iterator_category>
+  FrozenSet(InputIt first, InputIt last, const Compare &comp = Compare(),
+            const Allocator &alloc = Allocator())
+      : ft_(comp, alloc) {
+    ft_.assign_sorted(first, last);
+  }
+
+  iterator begin() const { return ft_.begin(); }
+  iterator end() const { return ft_.end(); }
+
+  bool empty() const { return ft_.empty(); }
+  size_type size() const { return ft_.size(); }
+  size_type max_size() const { return ft_.max_size(); }
+
+  void swap(FrozenSet &other) { ft_.swap(other.ft_); }
+
+  iterator find(const Key &key) const { return ft_.find(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &key) const {
+    return ft_.find(key);
+  }
+
+  bool contains(const Key &key) const { return ft_.contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K &key) const {
+    return ft_.contains(key);
+  }
+
+  size_type count(const Key &key) const { return ft_.count(key); }
+
+  iterator lower_bound(const Key &key) const { return ft_.lower_bound(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K &key) const {
+    return ft_.lower_bound(key);
+  }
+
+  iterator upper_bound(const Key &key) const { return ft_.upper_bound(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K &key) const {
+    return ft_.upper_bound(key);
+  }
+
+  key_compare key_comp() const { return ft_.key_comp(); }
+
+  allocator_type get_allocator() const { return ft_.get_allocator(); }
+
+ private:
+  tree_type ft_;
+};
+
+// Map frozen into an EytzingerTree. Neither keys nor values change after
+// construction.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+class FrozenMap {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using reference = const value_type &;
+  using const_reference = const value_type &;
+  using tree_type =
+      EytzingerTree<value_type, MapCompare<Key, T, Compare>, Allocator>;
+  using iterator = typename tree_type::Iterator;
+  using const_iterator = typename tree_type::ConstIterator;
+  using size_type = std::size_t;
+
+  FrozenMap() {}
+
+  FrozenMap(std::initializer_list<value_type> const &items) {
+    ft_.assign_sorted(items.begin(), items.end());
+  }
+
+  template <class InputIt, class = typename std::iterator_traits<
+                               InputIt>::iterator_category>
+  FrozenMap(InputIt first, InputIt last, const Compare &comp = Compare(),
+            const Allocator &alloc = Allocator())
+      : ft_(MapCompare<Key, T, Compare>(comp), alloc) {
+    ft_.assign_sorted(first, last);
+  }
+
+  const T &at(const Key &key) const {
+    auto iter = ft_.find(key);
+    if (iter == ft_.end())
+      throw std::out_of_range("The key does not exist in the map");
+    return iter->second;
+  }
+
+  iterator begin() const { return ft_.begin(); }
+  iterator end() const { return ft_.end(); }
+
+  bool empty() const { return ft_.empty(); }
+  size_type size() const { return ft_.size(); }
+  size_type max_size() const { return ft_.max_size(); }
+
+  void swap(FrozenMap &other) { ft_.swap(other.ft_); }
+
+  iterator find(const Key &key) const { return ft_.find(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &key) const {
+    return ft_.find(key);
+  }
+
+  bool contains(const Key &key) const { return ft_.contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K &key) const {
+    return ft_.contains(key);
+  }
+
+  size_type count(const Key &key) const { return ft_.count(key); }
+
+  iterator lower_bound(const Key &key) const { return ft_.lower_bound(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K &key) const {
+    return ft_.lower_bound(key);
+  }
+
+  iterator upper_bound(const Key &key) const { return ft_.upper_bound(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K &key) const {
+    return ft_.upper_bound(key);
+  }
+
+  key_compare key_comp() const { return ft_.key_comp(); }
+
+  allocator_type get_allocator() const { return ft_.get_allocator(); }
+
+ private:
+  tree_type ft_;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_FROZEN_H_
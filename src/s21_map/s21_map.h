@@ -1,35 +1,63 @@
 #ifndef CPP2_S21_CONTAINERS_1_SRC_S21_MAP_H_
 #define CPP2_S21_CONTAINERS_1_SRC_S21_MAP_H_
 
+#include "../s21_btree.h"
+#include "../s21_frozen.h"
+#include "../s21_persistent.h"
+#include "../s21_pool_allocator.h"
+#include "../s21_skip_list.h"
 #include "../s21_tree.h"
 
 namespace s21 {
-template <class Key, class T>
-class Map : BinaryTree<std::pair<Key, T>>
-
-{
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>,
+          class Container = BinaryTree<std::pair<const Key, T>,
+                                       MapCompare<Key, T, Compare>, Allocator>>
+class Map {
  public:
   using key_type = Key;
   using mapped_type = T;
   using value_type = std::pair<const key_type, mapped_type>;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
   using reference = value_type &;
   using const_reference = const value_type &;
-  using iterator = typename BinaryTree<value_type>::Iterator;
-  using const_iterator = typename BinaryTree<value_type>::ConstIterator;
+  using tree_type = Container;
+  using iterator = typename tree_type::Iterator;
+  using const_iterator = typename tree_type::ConstIterator;
   using size_type = std::size_t;
+  using node_type = typename tree_type::node_type;
+  using insert_return_type = typename tree_type::insert_return_type;
 
   Map() {}
 
+  explicit Map(const Compare &comp, const Allocator &alloc = Allocator())
+      : bt_(MapCompare<Key, T, Compare>(comp), alloc) {}
+
+  explicit Map(const Allocator &alloc) : bt_(alloc) {}
+
   Map(std::initializer_list<value_type> const &items) : bt_(items) {}
 
-  Map(const Map &m) : BinaryTree<std::pair<Key, T>>(), bt_(m.bt_) {}
+  template <class InputIt, class = typename std::iterator_traits<
+                               InputIt>::iterator_category>
+  Map(InputIt first, InputIt last) {
+    bt_.assign_sorted(first, last);
+  }
+
+  // Builds on threads from a random access range, see Parallel.
+  template <class InputIt>
+  Map(Parallel policy, InputIt first, InputIt last) {
+    bt_.assign_sorted(first, last, policy);
+  }
+
+  Map(const Map &m) : bt_(m.bt_) {}
 
   Map(Map &&m) noexcept : bt_(std::move(m.bt_)) {}
 
   ~Map() {}
 
   Map &operator=(Map &other) {
-    s21::Map<key_type, mapped_type> copy(other);
+    Map copy(other);
     *this = std::move(copy);
     return *this;
   }
@@ -40,35 +68,30 @@ class Map : BinaryTree<std::pair<Key, T>>
   }
 
   T &at(const Key &key) {
-    auto node = FindInMap(key);
-    if (node == nullptr)
+    auto iter = bt_.find(key);
+    if (iter == bt_.end())
       throw std::out_of_range("The key does not exist in the map");
-    return node->val.second;
+    return iter->second;
   }
 
   T &operator[](const Key &key) {
-    auto iter = FindInMap(key);
-    if (iter == nullptr) {
-      auto result = bt_.insert(std::make_pair(key, T()));
-      return result.first.get()->val.second;
-    }
-    return iter->val.second;
+    return try_emplace(key).first->second;
   }
 
   const T &at(const Key &key) const {
-    auto node = FindInMap(key);
-    if (node == nullptr)
+    auto iter = bt_.find(key);
+    if (iter == bt_.end())
       throw std::out_of_range("The key does not exist in the map");
-    return node->val.second;
+    return iter->second;
   }
 
   const T &operator[](const Key &key) const {
-    auto iter = FindInMap(key);
-    if (iter == nullptr) {
+    auto iter = bt_.find(key);
+    if (iter == bt_.end()) {
       auto result = bt_.insert(std::make_pair(key, T()));
-      return result.first.get()->val.second;
+      return result.first->second;
     }
-    return iter->val.second;
+    return iter->second;
   }
 
   iterator begin() { return bt_.begin(); }
@@ -91,70 +114,167 @@ class Map : BinaryTree<std::pair<Key, T>>
     return bt_.insert(value);
   }
 
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return bt_.insert(std::move(value));
+  }
+
+  iterator insert(const_iterator hint, const value_type &value) {
+    return bt_.insert(hint, value);
+  }
+
+  iterator insert(const_iterator hint, value_type &&value) {
+    return bt_.insert(hint, std::move(value));
+  }
+
   std::pair<iterator, bool> insert(const Key &key, const T &obj) {
-    return bt_.insert(std::make_pair(key, obj));
+    return bt_.emplace(key, obj);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return bt_.emplace(std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return bt_.emplace_hint(hint, std::forward<Args>(args)...);
+  }
+
+  // Builds the mapped value from args only if key is not in the map yet.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args) {
+    return bt_.try_emplace_key(
+        key, std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+    return bt_.try_emplace_key(
+        key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, const Key &key, Args &&...args) {
+    return bt_.try_emplace_hint(
+        hint, key, std::piecewise_construct, std::forward_as_tuple(key),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <class... Args>
+  iterator try_emplace(const_iterator hint, Key &&key, Args &&...args) {
+    return bt_.try_emplace_hint(
+        hint, key, std::piecewise_construct,
+        std::forward_as_tuple(std::move(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
   }
 
   std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj) {
-    auto node = FindInMap(key);
-    if (node) {
-      node->val.second = obj;
-      return std::make_pair(iterator(node), true);
+    auto iter = bt_.find(key);
+    if (iter != bt_.end()) {
+      iter->second = obj;
+      return std::make_pair(iter, true);
     }
     return insert(key, obj);
   }
 
+  insert_return_type insert(node_type &&node) {
+    return bt_.insert(std::move(node));
+  }
+
   void erase(iterator pos) { bt_.erase(pos); }
 
+  node_type extract(iterator pos) { return bt_.extract(pos); }
+
+  node_type extract(const Key &key) { return bt_.extract(key); }
+
   void swap(Map &other) { return bt_.swap(other.bt_); }
 
-  void merge(Map &other) {
-    if (&other != this) {
-      for (const auto &pair : other) {
-        insert_or_assign(pair.first, std::move(pair.second));
-      }
-      other.clear();
-    }
+  void merge(Map &other) { bt_.merge(other.bt_); }
+
+  void merge(Map &other, Parallel policy) { bt_.merge(other.bt_, policy); }
+
+  // Moves the elements whose keys are not less than key into the returned
+  // map; the others stay. O(log n) with the default tree.
+  Map split(const Key &key) {
+    Map high(key_comp(), get_allocator());
+    high.bt_ = bt_.split(key);
+    return high;
   }
 
-  bool contains(const Key &key) const {
-    bool found = false;
-    auto i = begin();
-    while (i != end() && !found) {
-      if ((*i).first == key)
-        found = true;
-      else
-        ++i;
-    }
-    return found;
+  // Moves all of other into this map in O(log n) when its keys all go
+  // after, or all before, the keys here. Throws std::invalid_argument if
+  // the ranges overlap.
+  void join(Map &other) { bt_.join(other.bt_); }
+
+  iterator find(const Key &key) { return bt_.find(key); }
+  const_iterator find(const Key &key) const { return bt_.find(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &key) {
+    return bt_.find(key);
   }
 
- private:
-  BinaryTree<value_type> bt_;
-
-  typename s21::BinaryTree<value_type>::BTNode *FindInMap(const Key &key) {
-    auto i = begin();
-    while (i != end()) {
-      if ((*i).first == key) {
-        return i.get();
-      }
-      ++i;
-    }
-    return nullptr;
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K &key) const {
+    return bt_.find(key);
   }
 
-  const typename s21::BinaryTree<value_type>::BTNode *FindInMap(
-      const Key &key) const {
-    auto i = begin();
-    while (i != end()) {
-      if ((*i).first == key) {
-        return i.get();
-      }
-      ++i;
-    }
-    return nullptr;
+  // Calls fn on every element in order. With a SkipList container this,
+  // unlike stepping an iterator, is safe while other threads erase.
+  template <class Fn>
+  void for_each(Fn fn) const { bt_.for_each(fn); }
+
+  bool contains(const Key &key) const { return bt_.contains(key); }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K &key) const {
+    return bt_.contains(key);
+  }
+
+  key_compare key_comp() const { return bt_.key_comp(); }
+
+  allocator_type get_allocator() const { return bt_.get_allocator(); }
+
+  // Read-only copy laid out for lookups, see EytzingerTree.
+  FrozenMap<Key, T, Compare, Allocator> freeze() const {
+    return FrozenMap<Key, T, Compare, Allocator>(begin(), end(), key_comp(),
+                                                 get_allocator());
   }
+
+  // Copy of the map as it is now. With a PersistentTree it shares every
+  // node with this map and takes O(1); other containers copy the values.
+  Map snapshot() const { return *this; }
+
+ private:
+  tree_type bt_;
 };
+
+// Map kept in a B+ tree: wide, cache-line aligned nodes instead of one node
+// per element.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+using BTreeMap =
+    Map<Key, T, Compare, Allocator,
+        BPlusTree<std::pair<const Key, T>, MapCompare<Key, T, Compare>,
+                  Allocator>>;
+
+// Map whose copies and snapshots share nodes until either side changes.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+using PersistentMap =
+    Map<Key, T, Compare, Allocator,
+        PersistentTree<std::pair<const Key, T>, MapCompare<Key, T, Compare>,
+                       Allocator>>;
+
+// Map that many threads may search and change at once without locks.
+template <class Key, class T, class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<const Key, T>>>
+using SkipListMap =
+    Map<Key, T, Compare, Allocator,
+        SkipList<std::pair<const Key, T>, MapCompare<Key, T, Compare>,
+                 Allocator>>;
 }  // namespace s21
 
 #endif  // CPP2_S21_CONTAINERS_1_SRC_S21_MAP_H_
@@ -1,26 +1,50 @@
 #ifndef CPP2_S21_CONTAINERS_1_SRC_S21_MULTISET_H_
 #define CPP2_S21_CONTAINERS_1_SRC_S21_MULTISET_H_
 
+#include "../s21_btree.h"
+#include "../s21_pool_allocator.h"
+#include "../s21_run_length_tree.h"
+#include "../s21_skip_list.h"
 #include "../s21_tree.h"
 
 namespace s21 {
-template <class Key, class Container = BinaryTree<Key, std::less<Key>>>
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>,
+          class Container = BinaryTree<Key, Compare, Allocator>>
 class Multiset {
  public:
   using key_type = Key;
   using value_type = Key;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
   using reference = value_type &;
   using const_reference = const value_type &;
   using iterator = typename Container::Iterator;
   using const_iterator = typename Container::ConstIterator;
   using size_type = std::size_t;
+  using node_type = typename Container::node_type;
 
   Multiset() {}
 
+  explicit Multiset(const Compare &comp, const Allocator &alloc = Allocator())
+      : bt_(comp, alloc) {}
+
+  explicit Multiset(const Allocator &alloc) : bt_(alloc) {}
+
   Multiset(std::initializer_list<value_type> const &items) {
-    for (auto value : items) {
-      bt_.insert_def(value);
-    }
+    bt_.assign_sorted_def(items.begin(), items.end());
+  }
+
+  template <class InputIt, class = typename std::iterator_traits<
+                               InputIt>::iterator_category>
+  Multiset(InputIt first, InputIt last) {
+    bt_.assign_sorted_def(first, last);
+  }
+
+  // Builds on threads from a random access range, see Parallel.
+  template <class InputIt>
+  Multiset(Parallel policy, InputIt first, InputIt last) {
+    bt_.assign_sorted_def(first, last, policy);
   }
 
   Multiset(const Multiset &s) : bt_(s.bt_) {}
@@ -32,7 +56,7 @@ class Multiset {
   Multiset &operator=(const Multiset &s) {
     clear();
     if (s.size() != 0) {
-      s21::Multiset<value_type> copy(s);
+      Multiset copy(s);
       *this = std::move(copy);
     }
     return *this;
@@ -63,19 +87,115 @@ class Multiset {
     return bt_.insert_def(value).first;
   }
 
+  iterator insert(value_type &&value) {
+    return bt_.emplace_def(std::move(value));
+  }
+
+  iterator insert(const_iterator hint, const value_type &value) {
+    return bt_.insert_def(hint, value);
+  }
+
+  iterator insert(const_iterator hint, value_type &&value) {
+    return bt_.emplace_hint_def(hint, std::move(value));
+  }
+
+  iterator insert(node_type &&node) { return bt_.insert_def(std::move(node)); }
+
   void erase(iterator pos) { bt_.erase(pos); }
 
+  node_type extract(iterator pos) { return bt_.extract(pos); }
+
+  node_type extract(const Key &key) { return bt_.extract(key); }
+
   void swap(Multiset &other) { bt_.swap(other.bt_); }
 
   void merge(Multiset &other) { bt_.merge_multiset(other.bt_); }
 
+  void merge(Multiset &other, Parallel policy) {
+    bt_.merge_multiset(other.bt_, policy);
+  }
+
+  // Moves the elements not less than key into the returned multiset; those
+  // less than key stay. O(log n) with the default tree.
+  Multiset split(const Key &key) {
+    Multiset high(key_comp(), get_allocator());
+    high.bt_ = bt_.split(key);
+    return high;
+  }
+
+  // Moves all of other into this multiset in O(log n) when its elements
+  // all go after, or all before, the ones here; equal keys may meet at the
+  // boundary. Throws std::invalid_argument if the ranges overlap.
+  void join(Multiset &other) { bt_.join_multiset(other.bt_); }
+
+  // New multisets built in one ordered pass over both operands, see
+  // BinaryTree::set_union; the result takes this multiset's allocator.
+  Multiset set_union(const Multiset &other) const {
+    return Multiset(bt_.set_union(other.bt_));
+  }
+
+  Multiset set_intersection(const Multiset &other) const {
+    return Multiset(bt_.set_intersection(other.bt_));
+  }
+
+  Multiset set_difference(const Multiset &other) const {
+    return Multiset(bt_.set_difference(other.bt_));
+  }
+
+  Multiset set_symmetric_difference(const Multiset &other) const {
+    return Multiset(bt_.set_symmetric_difference(other.bt_));
+  }
+
+  // The same on threads, see Parallel; BinaryTree containers only.
+  Multiset set_union(const Multiset &other, Parallel policy) const {
+    return Multiset(bt_.set_union(other.bt_, policy));
+  }
+
+  Multiset set_intersection(const Multiset &other, Parallel policy) const {
+    return Multiset(bt_.set_intersection(other.bt_, policy));
+  }
+
+  Multiset set_difference(const Multiset &other, Parallel policy) const {
+    return Multiset(bt_.set_difference(other.bt_, policy));
+  }
+
+  Multiset set_symmetric_difference(const Multiset &other,
+                                    Parallel policy) const {
+    return Multiset(bt_.set_symmetric_difference(other.bt_, policy));
+  }
+
   iterator find(const Key &key) { return bt_.find(key); }
   const_iterator find(const Key &key) const { return bt_.find(key); }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &key) {
+    return bt_.find(key);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K &key) const {
+    return bt_.find(key);
+  }
+
+  // Calls fn on every element in order. With a SkipList container this,
+  // unlike stepping an iterator, is safe while other threads erase.
+  template <class Fn>
+  void for_each(Fn fn) const { bt_.for_each(fn); }
+
   bool contains(const Key &key) const { return bt_.contains(key); }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K &key) const {
+    return bt_.contains(key);
+  }
+
   size_type count(const Key &key) const { return bt_.count(key); }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  size_type count(const K &key) const {
+    return bt_.count(key);
+  }
+
   std::pair<iterator, iterator> equal_range(const Key &key) {
     return std::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
   }
@@ -85,28 +205,82 @@ class Multiset {
                                                      upper_bound(key));
   }
 
-  iterator lower_bound(const Key &key) {
-    return iterator(bt_.lower_bound(key));
-  }
+  iterator lower_bound(const Key &key) { return bt_.lower_bound(key); }
   const_iterator lower_bound(const Key &key) const {
-    return const_iterator(bt_.lower_bound(key));
+    return bt_.lower_bound(key);
   }
 
-  iterator upper_bound(const Key &key) {
-    return iterator(bt_.upper_bound(key));
-  }
+  iterator upper_bound(const Key &key) { return bt_.upper_bound(key); }
   const_iterator upper_bound(const Key &key) const {
-    return const_iterator(bt_.upper_bound(key));
+    return bt_.upper_bound(key);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const K &key) {
+    return bt_.lower_bound(key);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const K &key) const {
+    return bt_.lower_bound(key);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const K &key) {
+    return bt_.upper_bound(key);
   }
 
-  template <typename... Args>
-  std::pair<iterator, bool> emplace(Args &&...args) {
-    return bt_.emplace(std::forward<Args>(args)...);
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const K &key) const {
+    return bt_.upper_bound(key);
+  }
+
+  iterator nth(size_type k) { return bt_.nth(k); }
+  const_iterator nth(size_type k) const { return bt_.nth(k); }
+
+  size_type rank(const Key &key) const { return bt_.rank(key); }
+
+  size_type count_range(const Key &lo, const Key &hi) const {
+    return bt_.count_range(lo, hi);
+  }
+
+  key_compare key_comp() const { return bt_.key_comp(); }
+
+  allocator_type get_allocator() const { return bt_.get_allocator(); }
+
+  template <class... Args>
+  iterator emplace(Args &&...args) {
+    return bt_.emplace_def(std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return bt_.emplace_hint_def(hint, std::forward<Args>(args)...);
   }
 
  private:
+  explicit Multiset(Container &&bt) : bt_(std::move(bt)) {}
+
   Container bt_;
 };
+
+// Multiset that keeps each distinct key once, with a count of its copies.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using CompactMultiset =
+    Multiset<Key, Compare, Allocator, RunLengthTree<Key, Compare, Allocator>>;
+
+// Multiset kept in a B+ tree; equal keys share leaves.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using BTreeMultiset =
+    Multiset<Key, Compare, Allocator, BPlusTree<Key, Compare, Allocator>>;
+
+// Multiset that many threads may search and change at once without locks.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using SkipListMultiset =
+    Multiset<Key, Compare, Allocator, SkipList<Key, Compare, Allocator>>;
 }  // namespace s21
 
 #endif  // CPP2_S21_CONTAINERS_1_SRC_S21_MULTISET_H_
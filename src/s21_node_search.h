@@ -0,0 +1,156 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_NODE_SEARCH_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_NODE_SEARCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "s21_tree.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define S21_NODE_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+// Search policies for the nodes of BPlusTree. Find() returns the index of
+// the first of n sorted keys that is not less than key or, for upper, that
+// is greater than key.
+struct BinaryNodeSearch {
+  template <class T, class Key, class Compare>
+  static size_t Find(const T *keys, size_t n, const Key &key,
+                     const Compare &comp, bool upper) {
+    if (upper) {
+      return std::upper_bound(keys, keys + n, key,
+                              [&comp](const Key &k, const T &t) {
+                                return comp(k, t);
+                              }) -
+             keys;
+    }
+    return std::lower_bound(keys, keys + n, key,
+                            [&comp](const T &t, const Key &k) {
+                              return comp(t, k);
+                            }) -
+           keys;
+  }
+};
+
+// Comparators that order keys by operator<, so that keys can be compared
+// as raw numbers.
+template <class Compare, class T>
+struct IsPlainLess
+    : std::disjunction<std::is_same<Compare, std::less<T>>,
+                       std::is_same<Compare, std::less<>>> {};
+
+template <class Key, class V, class Compare, class T>
+struct IsPlainLess<MapCompare<Key, V, Compare>, T> : IsPlainLess<Compare, T> {
+};
+
+template <class T>
+struct IsPackedKey
+    : std::disjunction<
+          std::conjunction<std::is_integral<T>,
+                           std::negation<std::is_same<T, bool>>,
+                           std::bool_constant<sizeof(T) == 4 ||
+                                              sizeof(T) == 8>>,
+          std::is_same<T, float>, std::is_same<T, double>> {};
+
+#ifdef S21_NODE_SEARCH_X86
+// Lane mask of the keys[0..lanes) that come before key: less than key, or
+// not greater for upper. Unsigned keys are shifted into signed range.
+template <class T>
+__attribute__((target("avx2"))) inline unsigned BeforeMaskAvx2(const T *keys,
+                                                                T key,
+                                                                bool upper) {
+  if constexpr (std::is_same_v<T, double>) {
+    __m256d data = _mm256_loadu_pd(keys);
+    __m256d probe = _mm256_set1_pd(key);
+    return _mm256_movemask_pd(upper ? _mm256_cmp_pd(data, probe, _CMP_LE_OQ)
+                                    : _mm256_cmp_pd(data, probe, _CMP_LT_OQ));
+  } else if constexpr (std::is_same_v<T, float>) {
+    __m256 data = _mm256_loadu_ps(keys);
+    __m256 probe = _mm256_set1_ps(key);
+    return _mm256_movemask_ps(upper ? _mm256_cmp_ps(data, probe, _CMP_LE_OQ)
+                                    : _mm256_cmp_ps(data, probe, _CMP_LT_OQ));
+  } else if constexpr (sizeof(T) == 4) {
+    const __m256i bias =
+        _mm256_set1_epi32(std::is_signed_v<T> ? 0 : INT32_MIN);
+    __m256i data = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys)), bias);
+    __m256i probe =
+        _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(key)), bias);
+    if (upper) {
+      return ~_mm256_movemask_ps(
+                 _mm256_castsi256_ps(_mm256_cmpgt_epi32(data, probe))) &
+             0xFFu;
+    }
+    return _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpgt_epi32(probe, data)));
+  } else {
+    const __m256i bias =
+        _mm256_set1_epi64x(std::is_signed_v<T> ? 0 : INT64_MIN);
+    __m256i data = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys)), bias);
+    __m256i probe =
+        _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), bias);
+    if (upper) {
+      return ~_mm256_movemask_pd(
+                 _mm256_castsi256_pd(_mm256_cmpgt_epi64(data, probe))) &
+             0xFu;
+    }
+    return _mm256_movemask_pd(
+        _mm256_castsi256_pd(_mm256_cmpgt_epi64(probe, data)));
+  }
+}
+
+// Scans a vector of keys at a time. The keys are sorted, so the first
+// vector that is not wholly before key holds the answer.
+template <class T>
+__attribute__((target("avx2"))) inline size_t FindAvx2(const T *keys,
+                                                       size_t n, T key,
+                                                       bool upper) {
+  constexpr size_t kLanes = 32 / sizeof(T);
+  constexpr unsigned kAll = (1u << kLanes) - 1;
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    unsigned mask = BeforeMaskAvx2(keys + i, key, upper);
+    if (mask != kAll) return i + __builtin_popcount(mask);
+  }
+  while (i < n && (upper ? !(key < keys[i]) : keys[i] < key)) ++i;
+  return i;
+}
+
+inline bool HasAvx2() {
+#ifdef __AVX2__
+  return true;
+#else
+  static const bool has_avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return has_avx2;
+#endif
+}
+#endif
+
+// Compares whole nodes of int32/int64/uint64/double (or float) keys with
+// AVX2 when the CPU has it, checked once at run time; other key types,
+// comparators and CPUs use BinaryNodeSearch.
+struct SimdNodeSearch {
+  template <class T, class Key, class Compare>
+  static size_t Find(const T *keys, size_t n, const Key &key,
+                     const Compare &comp, bool upper) {
+#ifdef S21_NODE_SEARCH_X86
+    if constexpr (std::is_same_v<T, Key> && IsPackedKey<T>::value &&
+                  IsPlainLess<Compare, T>::value) {
+      if (HasAvx2()) return FindAvx2(keys, n, key, upper);
+    }
+#endif
+    return BinaryNodeSearch::Find(keys, n, key, comp, upper);
+  }
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_NODE_SEARCH_H_
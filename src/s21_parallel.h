@@ -0,0 +1,76 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_PARALLEL_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_PARALLEL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+// Execution policy for the bulk operations of the tree containers:
+// construction from a range, merge and the set algebra. Plays the part of
+// std::execution::par, but with an explicit number of threads; the default
+// is one per hardware thread.
+struct Parallel {
+  Parallel() : Parallel(std::thread::hardware_concurrency()) {}
+  explicit Parallel(unsigned count) : threads(std::max(1u, count)) {}
+
+  unsigned threads;
+};
+
+// Work below this many elements per thread is not worth a thread start.
+constexpr size_t kParallelGrain = size_t(1) << 14;
+
+// How many tasks to cut items into for up to threads threads.
+inline size_t ParallelTasks(size_t items, unsigned threads) {
+  return std::max<size_t>(
+      1, std::min<size_t>(threads, items / kParallelGrain));
+}
+
+// Runs fn(0) ... fn(tasks - 1), the last one on the calling thread, and
+// returns when all have finished. The first exception thrown by a task is
+// rethrown then. A task whose thread fails to start runs inline, and so do
+// all of them if the bookkeeping cannot be allocated: tasks that do not
+// throw can count on ParallelFor not to throw either.
+template <class Fn>
+void ParallelFor(size_t tasks, Fn fn) {
+  std::vector<std::exception_ptr> errors;
+  std::vector<std::thread> workers;
+  try {
+    if (tasks > 1) {
+      errors.resize(tasks);
+      workers.reserve(tasks);
+    }
+  } catch (const std::bad_alloc &) {
+    errors.clear();
+  }
+  if (errors.empty()) {
+    for (size_t task = 0; task < tasks; ++task) fn(task);
+    return;
+  }
+  auto run = [&fn, &errors](size_t task) {
+    try {
+      fn(task);
+    } catch (...) {
+      errors[task] = std::current_exception();
+    }
+  };
+  for (size_t task = 0; task + 1 < tasks; ++task) {
+    try {
+      workers.emplace_back(run, task);
+    } catch (const std::system_error &) {
+      run(task);
+    }
+  }
+  run(tasks - 1);
+  for (std::thread &worker : workers) worker.join();
+  for (std::exception_ptr &error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_PARALLEL_H_
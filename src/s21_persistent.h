@@ -0,0 +1,698 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_PERSISTENT_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_PERSISTENT_H_
+
+#include <atomic>
+
+#include "s21_tree.h"
+
+namespace s21 {
+// AVL tree with the interface of BinaryTree whose copies share nodes, usable
+// as the Container of Set and Map. A copy only takes a reference to the
+// root, so snapshots cost O(1); an update copies the nodes on its path that
+// are still shared and links the copies to the untouched subtrees. Shared
+// nodes are never written and their reference counts are atomic, so copies
+// may be read and released on other threads while the original changes.
+// One tree object is not safe to use from several threads at once.
+//
+// Nodes have no parent links: iterators carry their path from the root,
+// and any change to the tree invalidates them. A non-const map iterator
+// copies the shared nodes on its path when it is dereferenced, which
+// counts as a change. Keys are unique; there is no Multiset support.
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>>
+class PersistentTree : private EmptyBaseHolder<Compare, 0>,
+                       private EmptyBaseHolder<Allocator, 1> {
+ public:
+  using key_type = typename KeyOfValue<K, Compare>::type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using value_type = K;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = size_t;
+  using node_type = NodeHandle<K, TreeNodeAllocator<K, Allocator>>;
+
+ private:
+  struct Node {
+    template <class... Args>
+    explicit Node(std::in_place_t, Args &&...args)
+        : val(std::forward<Args>(args)...) {}
+
+    std::atomic<size_type> refs{1};
+    Node *left = nullptr;
+    Node *right = nullptr;
+    int height = 1;
+    K val;
+  };
+
+  // An AVL tree of n nodes is less than 1.45 * log2(n + 2) levels deep, so
+  // this bounds the paths of any tree that fits in memory.
+  static constexpr size_type kMaxDepth = 96;
+
+ public:
+  // The nodes from the root down to the current one; end() has none.
+  template <bool IsConst>
+  class PathIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<IsConst || std::is_same_v<key_type, K>, const K &,
+                           K &>;
+    using pointer = std::remove_reference_t<reference> *;
+    using Tree =
+        std::conditional_t<IsConst, const PersistentTree, PersistentTree>;
+
+    PathIterator() = default;
+    explicit PathIterator(Tree *tree) : tree_(tree) {}
+
+    PathIterator(const PathIterator &other) { *this = other; }
+
+    template <bool C = IsConst, class = std::enable_if_t<C>>
+    PathIterator(const PathIterator<false> &other)
+        : tree_(other.tree_), depth_(other.depth_), owned_(other.owned_) {
+      std::copy_n(other.path_, depth_, path_);
+    }
+
+    PathIterator &operator=(const PathIterator &other) {
+      tree_ = other.tree_;
+      depth_ = other.depth_;
+      owned_ = other.owned_;
+      std::copy_n(other.path_, depth_, path_);
+      return *this;
+    }
+
+    reference operator*() const {
+      if constexpr (!std::is_const_v<std::remove_reference_t<reference>>) {
+        Detach();
+      }
+      return Top()->val;
+    }
+    pointer operator->() const { return &**this; }
+
+    PathIterator &operator++() {
+      Step(true);
+      return *this;
+    }
+
+    PathIterator &operator--() {
+      Step(false);
+      return *this;
+    }
+
+    PathIterator operator++(int) {
+      PathIterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    PathIterator operator--(int) {
+      PathIterator prev = *this;
+      --*this;
+      return prev;
+    }
+
+    bool operator==(const PathIterator &other) const {
+      return Top() == other.Top();
+    }
+
+    bool operator!=(const PathIterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    Node *Top() const { return depth_ ? path_[depth_ - 1] : nullptr; }
+
+    // In-order neighbour: the extreme node of the subtree on that side or
+    // the first ancestor entered from the other side. From end() forward
+    // goes to the first node and back to the last.
+    void Step(bool forward) {
+      Node *child = depth_ ? Child(path_[depth_ - 1], forward) : tree_->root_;
+      if (child) {
+        path_[depth_++] = child;
+        while ((child = Child(child, !forward))) path_[depth_++] = child;
+        return;
+      }
+      while (depth_ > 1 &&
+             Child(path_[depth_ - 2], forward) == path_[depth_ - 1]) {
+        --depth_;
+      }
+      if (depth_ > 0) --depth_;
+      owned_ = std::min(owned_, depth_);
+    }
+
+    // Copies the shared nodes on the path, so that the value can be
+    // written without a snapshot seeing it. The first owned_ nodes are
+    // known to be private already.
+    void Detach() const {
+      for (; owned_ < depth_; ++owned_) {
+        Node *parent = owned_ ? path_[owned_ - 1] : nullptr;
+        Node *&link = !parent                            ? tree_->root_
+                      : parent->left == path_[owned_] ? parent->left
+                                                         : parent->right;
+        path_[owned_] = tree_->Own(link);
+      }
+    }
+
+    Tree *tree_ = nullptr;
+    mutable Node *path_[kMaxDepth];
+    size_type depth_ = 0;
+    mutable size_type owned_ = 0;
+
+    template <bool>
+    friend class PathIterator;
+    friend class PersistentTree;
+  };
+
+  using Iterator = PathIterator<false>;
+  using ConstIterator = PathIterator<true>;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+  using insert_return_type = InsertReturnType<iterator, node_type>;
+
+  PersistentTree() {}
+
+  explicit PersistentTree(const Compare &comp,
+                          const Allocator &alloc = Allocator())
+      : CompareBase(comp), AllocatorBase(alloc) {}
+
+  explicit PersistentTree(const Allocator &alloc)
+      : PersistentTree(Compare(), alloc) {}
+
+  PersistentTree(std::initializer_list<value_type> const &items)
+      : PersistentTree() {
+    assign_sorted(items.begin(), items.end());
+  }
+
+  // Shares every node with other when the allocators can free each
+  // other's nodes; otherwise copies the values.
+  PersistentTree(const PersistentTree &other)
+      : PersistentTree(other.key_comp(),
+                       std::allocator_traits<Allocator>::
+                           select_on_container_copy_construction(
+                               other.get_allocator())) {
+    if (alloc() == other.alloc()) {
+      root_ = Acquire(other.root_);
+      size_ = other.size_;
+    } else {
+      const_iterator it = other.begin();
+      BuildSorted(other.size_, [&it]() -> const K & { return *it++; });
+    }
+  }
+
+  PersistentTree(PersistentTree &&other) noexcept
+      : PersistentTree(other.key_comp(), other.get_allocator()) {
+    swap(other);
+  }
+
+  ~PersistentTree() { clear(); }
+
+  PersistentTree &operator=(PersistentTree &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  iterator begin() { return ++end(); }
+  iterator end() { return iterator(this); }
+  const_iterator begin() const { return ++end(); }
+  const_iterator end() const { return const_iterator(this); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_type size() const { return size_; }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() / sizeof(Node);
+  }
+
+  void clear() {
+    Release(root_);
+    root_ = nullptr;
+    size_ = 0;
+  }
+
+  void swap(PersistentTree &other) {
+    std::swap(comp(), other.comp());
+    std::swap(alloc(), other.alloc());
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return InsertUnique(KeyOf(value), value);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return InsertUnique(KeyOf(value), std::move(value));
+  }
+
+  // Hints are accepted for compatibility and otherwise ignored: the path
+  // has to be walked from the root to be copied anyway.
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value).first;
+  }
+
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value)).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    using ArgsKey = EmplaceKey<key_type, value_type, std::decay_t<Args>...>;
+    if constexpr (ArgsKey::value) {
+      return InsertUnique(ArgsKey::Get(args...), std::forward<Args>(args)...);
+    } else {
+      value_type value(std::forward<Args>(args)...);
+      return InsertUnique(KeyOf(value), std::move(value));
+    }
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace_key(const key_type &key,
+                                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace_hint(const_iterator, const key_type &key,
+                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...).first;
+  }
+
+  // Builds a balanced tree in O(n) when [first, last) is sorted; otherwise
+  // the range is sorted first. Keeps the first of equal values.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    std::vector<K> values;
+    std::vector<K *> order = SortedOrder(first, last, comp(), true, values);
+    PersistentTree built(comp(), alloc());
+    size_type i = 0;
+    built.BuildSorted(order.size(), [&order, &i]() -> K && {
+      return std::move(*order[i++]);
+    });
+    swap(built);
+  }
+
+  // Moves the values whose keys are missing here out of other.
+  void merge(PersistentTree &other) {
+    if (this == &other) return;
+    std::vector<key_type> keys;
+    for (const_iterator it = std::as_const(other).begin();
+         it != other.end(); ++it) {
+      if (!contains(KeyOf(*it))) keys.push_back(KeyOf(*it));
+    }
+    for (const key_type &key : keys) insert(other.extract(key));
+  }
+
+  iterator find(const key_type &key) { return FindPos<false>(key); }
+
+  const_iterator find(const key_type &key) const {
+    return FindPos<true>(key);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) {
+    return FindPos<false>(key);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const Key &key) const {
+    return FindPos<true>(key);
+  }
+
+  iterator lower_bound(const key_type &key) {
+    return BoundPos<false>(key, false);
+  }
+
+  const_iterator lower_bound(const key_type &key) const {
+    return BoundPos<true>(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) {
+    return BoundPos<false>(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key &key) const {
+    return BoundPos<true>(key, false);
+  }
+
+  iterator upper_bound(const key_type &key) {
+    return BoundPos<false>(key, true);
+  }
+
+  const_iterator upper_bound(const key_type &key) const {
+    return BoundPos<true>(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) {
+    return BoundPos<false>(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key &key) const {
+    return BoundPos<true>(key, true);
+  }
+
+  size_type count(const key_type &key) const { return contains(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return contains(key);
+  }
+
+  bool contains(const key_type &key) const { return FindNode(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return FindNode(key);
+  }
+
+  key_compare key_comp() const { return comp(); }
+
+  allocator_type get_allocator() const { return alloc(); }
+
+  void erase(iterator pos) {
+    if (pos == end()) throw std::out_of_range("List is empty");
+    DeleteNode(Unlink(KeyOf(pos.Top()->val)));
+  }
+
+  node_type extract(iterator pos) {
+    if (pos == end()) return node_type();
+    NodeAllocator node_alloc(alloc());
+    TreeNode<K> *handle = HandleTraits::allocate(node_alloc, 1);
+    Node *node = Unlink(KeyOf(pos.Top()->val));
+    try {
+      HandleTraits::construct(node_alloc, handle, std::in_place,
+                              std::move(node->val));
+    } catch (...) {
+      HandleTraits::deallocate(node_alloc, handle, 1);
+      DeleteNode(node);
+      throw;
+    }
+    DeleteNode(node);
+    return node_type(handle, node_alloc);
+  }
+
+  node_type extract(const key_type &key) { return extract(find(key)); }
+
+  insert_return_type insert(node_type &&node) {
+    if (node.empty()) return {end(), false, node_type()};
+    auto result = InsertUnique(KeyOf(node.value()), std::move(node.value()));
+    if (!result.second) return {result.first, false, std::move(node)};
+    node.reset();
+    return {result.first, true, node_type()};
+  }
+
+ private:
+  using CompareBase = EmptyBaseHolder<Compare, 0>;
+  using AllocatorBase = EmptyBaseHolder<Allocator, 1>;
+  using NodeTraits = typename std::allocator_traits<
+      Allocator>::template rebind_traits<Node>;
+  using NodeAllocator = TreeNodeAllocator<K, Allocator>;
+  using HandleTraits = std::allocator_traits<NodeAllocator>;
+
+  const Compare &comp() const { return CompareBase::get(); }
+  Compare &comp() { return CompareBase::get(); }
+  const Allocator &alloc() const { return AllocatorBase::get(); }
+  Allocator &alloc() { return AllocatorBase::get(); }
+
+  static const key_type &KeyOf(const value_type &value) {
+    return KeyOfValue<K, Compare>::Get(value);
+  }
+
+  template <class Lhs, class Rhs>
+  bool Less(const Lhs &lhs, const Rhs &rhs) const {
+    return comp()(lhs, rhs);
+  }
+
+  static Node *Child(Node *node, bool right) {
+    return right ? node->right : node->left;
+  }
+
+  static int Height(const Node *node) { return node ? node->height : 0; }
+
+  static void Update(Node *node) {
+    node->height = 1 + std::max(Height(node->left), Height(node->right));
+  }
+
+  template <class... Args>
+  Node *NewNode(Args &&...args) {
+    typename NodeTraits::allocator_type node_alloc(alloc());
+    Node *node = NodeTraits::allocate(node_alloc, 1);
+    try {
+      NodeTraits::construct(node_alloc, node, std::in_place,
+                            std::forward<Args>(args)...);
+    } catch (...) {
+      NodeTraits::deallocate(node_alloc, node, 1);
+      throw;
+    }
+    return node;
+  }
+
+  void DeleteNode(Node *node) {
+    typename NodeTraits::allocator_type node_alloc(alloc());
+    NodeTraits::destroy(node_alloc, node);
+    NodeTraits::deallocate(node_alloc, node, 1);
+  }
+
+  static Node *Acquire(Node *node) {
+    if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+    return node;
+  }
+
+  // The last owner frees the node and lets go of its children.
+  void Release(Node *node) {
+    if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      Release(node->left);
+      Release(node->right);
+      DeleteNode(node);
+    }
+  }
+
+  // Makes the node at link private to this tree, replacing it with a copy
+  // while another tree holds it too. Only called on links inside nodes
+  // that are private already, so a count of one cannot grow meanwhile.
+  Node *Own(Node *&link) {
+    Node *node = link;
+    if (node->refs.load(std::memory_order_acquire) == 1) return node;
+    Node *copy = NewNode(node->val);
+    copy->left = Acquire(node->left);
+    copy->right = Acquire(node->right);
+    copy->height = node->height;
+    link = copy;
+    Release(node);
+    return copy;
+  }
+
+  // Rotations lift a child over a private node; the child is made private
+  // first.
+  Node *RotateLeft(Node *node) {
+    Node *right = Own(node->right);
+    node->right = right->left;
+    right->left = node;
+    Update(node);
+    Update(right);
+    return right;
+  }
+
+  Node *RotateRight(Node *node) {
+    Node *left = Own(node->left);
+    node->left = left->right;
+    left->right = node;
+    Update(node);
+    Update(left);
+    return left;
+  }
+
+  Node *Balance(Node *node) {
+    Update(node);
+    int balance = Height(node->left) - Height(node->right);
+    if (balance > 1) {
+      if (Height(node->left->right) > Height(node->left->left)) {
+        node->left = RotateLeft(Own(node->left));
+      }
+      return RotateRight(node);
+    }
+    if (balance < -1) {
+      if (Height(node->right->left) > Height(node->right->right)) {
+        node->right = RotateRight(Own(node->right));
+      }
+      return RotateLeft(node);
+    }
+    return node;
+  }
+
+  // Rebalances the nodes at links, deepest first, until a subtree keeps
+  // its height. A value copy that throws here leaves a valid search tree
+  // that is at worst slightly out of balance.
+  void Rebalance(Node **links[], size_type depth) {
+    while (depth-- > 0) {
+      Node *node = *links[depth];
+      int height = node->height;
+      *links[depth] = Balance(node);
+      if (*links[depth] == node && node->height == height) break;
+    }
+  }
+
+  template <class Key>
+  Node *FindNode(const Key &key) const {
+    Node *node = root_;
+    while (node) {
+      if (Less(key, KeyOf(node->val))) {
+        node = node->left;
+      } else if (Less(KeyOf(node->val), key)) {
+        node = node->right;
+      } else {
+        break;
+      }
+    }
+    return node;
+  }
+
+  // The first node not less than key, or for upper greater than key, with
+  // the path down to it.
+  template <bool IsConst, class Key>
+  PathIterator<IsConst> BoundPos(const Key &key, bool upper) const {
+    PathIterator<IsConst> pos(const_cast<PersistentTree *>(this));
+    size_type depth = 0;
+    for (Node *node = root_; node;) {
+      pos.path_[depth++] = node;
+      if (upper ? Less(key, KeyOf(node->val))
+                : !Less(KeyOf(node->val), key)) {
+        pos.depth_ = depth;
+        node = node->left;
+      } else {
+        node = node->right;
+      }
+    }
+    return pos;
+  }
+
+  template <bool IsConst, class Key>
+  PathIterator<IsConst> FindPos(const Key &key) const {
+    PathIterator<IsConst> pos = BoundPos<IsConst>(key, false);
+    if (pos.depth_ && Less(key, KeyOf(pos.Top()->val))) pos.depth_ = 0;
+    return pos;
+  }
+
+  // The value is only built once the key is known to be missing. Args may
+  // hold the key itself, so it is read back from the new node.
+  template <class... Args>
+  std::pair<iterator, bool> InsertUnique(const key_type &key,
+                                         Args &&...args) {
+    iterator pos = BoundPos<false>(key, false);
+    if (pos.depth_ && !Less(key, KeyOf(pos.Top()->val))) {
+      return std::make_pair(pos, false);
+    }
+    Node *node = NewNode(std::forward<Args>(args)...);
+    LinkNode(node);
+    return std::make_pair(BoundPos<false>(KeyOf(node->val), false), true);
+  }
+
+  // Copies the shared nodes on the way down, then hangs node below them.
+  void LinkNode(Node *node) {
+    Node **links[kMaxDepth];
+    size_type depth = 0;
+    Node **link = &root_;
+    try {
+      while (*link) {
+        Node *parent = Own(*link);
+        links[depth++] = link;
+        link = Less(KeyOf(node->val), KeyOf(parent->val)) ? &parent->left
+                                                          : &parent->right;
+      }
+    } catch (...) {
+      DeleteNode(node);
+      throw;
+    }
+    *link = node;
+    ++size_;
+    Rebalance(links, depth);
+  }
+
+  // Takes the node holding key, which must be in the tree, out of it and
+  // returns it private, with no children. A node with two children gives
+  // way to the least node of its right subtree. Key may live in that node,
+  // so it is not read once the node has been made private.
+  template <class Key>
+  Node *Unlink(const Key &key) {
+    Node **links[kMaxDepth];
+    size_type depth = 0;
+    Node **link = &root_;
+    for (;;) {
+      bool left = Less(key, KeyOf((*link)->val));
+      if (!left && !Less(KeyOf((*link)->val), key)) break;
+      Node *parent = Own(*link);
+      links[depth++] = link;
+      link = left ? &parent->left : &parent->right;
+    }
+    Node *node = Own(*link);
+    if (node->left && node->right) {
+      size_type at = depth;
+      links[depth++] = link;
+      Node **spine = &node->right;
+      Node *least = Own(*spine);
+      while (least->left) {
+        links[depth++] = spine;
+        spine = &least->left;
+        least = Own(*spine);
+      }
+      *spine = least->right;
+      least->left = node->left;
+      least->right = node->right;
+      least->height = node->height;
+      *link = least;
+      if (depth > at + 1) links[at + 1] = &least->right;
+    } else {
+      *link = node->left ? node->left : node->right;
+    }
+    node->left = node->right = nullptr;
+    --size_;
+    Rebalance(links, depth);
+    return node;
+  }
+
+  // Builds a balanced tree of n values taken in order from next().
+  template <class Source>
+  void BuildSorted(size_type n, Source next) {
+    root_ = Build(n, next);
+    size_ = n;
+  }
+
+  template <class Source>
+  Node *Build(size_type n, Source &next) {
+    if (n == 0) return nullptr;
+    Node *left = Build(n / 2, next);
+    Node *node = nullptr;
+    try {
+      node = NewNode(next());
+    } catch (...) {
+      Release(left);
+      throw;
+    }
+    node->left = left;
+    try {
+      node->right = Build(n - n / 2 - 1, next);
+    } catch (...) {
+      Release(node);
+      throw;
+    }
+    Update(node);
+    return node;
+  }
+
+  Node *root_ = nullptr;
+  size_type size_ = 0;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_PERSISTENT_H_
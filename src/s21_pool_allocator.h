@@ -0,0 +1,160 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_POOL_ALLOCATOR_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_POOL_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace s21 {
+// Fixed-size slot storage behind PoolAllocator. Slots are carved out of
+// blocks of block_slots slots and recycled through a free list; blocks go
+// back to the system only all at once, from Release() or the destructor.
+// The slot size is taken from the first request. Not thread-safe.
+class NodePool {
+ public:
+  using size_type = std::size_t;
+
+  explicit NodePool(size_type block_slots) : block_slots_(block_slots) {}
+
+  NodePool(const NodePool &) = delete;
+  NodePool &operator=(const NodePool &) = delete;
+
+  ~NodePool() { FreeBlocks(); }
+
+  bool Fits(size_type size, size_type align) const {
+    return align <= alignof(std::max_align_t) &&
+           (slot_size_ == 0 || size <= slot_size_);
+  }
+
+  void *Allocate(size_type size) {
+    if (slot_size_ == 0) {
+      size_type min_size = size < sizeof(Slot) ? sizeof(Slot) : size;
+      slot_size_ = (min_size + alignof(std::max_align_t) - 1) /
+                   alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+    if (free_list_ == nullptr) Grow();
+    Slot *slot = free_list_;
+    free_list_ = slot->next;
+    ++allocated_;
+    return slot;
+  }
+
+  void Deallocate(void *ptr) {
+    auto *slot = static_cast<Slot *>(ptr);
+    slot->next = free_list_;
+    free_list_ = slot;
+    --allocated_;
+  }
+
+  // Hands every block back to the system. Only possible while no slot is
+  // in use.
+  bool Release() {
+    if (allocated_) return false;
+    FreeBlocks();
+    return true;
+  }
+
+  size_type allocated() const { return allocated_; }
+  size_type capacity() const { return blocks_.size() * block_slots_; }
+  size_type blocks() const { return blocks_.size(); }
+
+ private:
+  struct Slot {
+    Slot *next;
+  };
+
+  void Grow() {
+    auto *block =
+        static_cast<char *>(::operator new(slot_size_ * block_slots_));
+    blocks_.push_back(block);
+    for (size_type i = block_slots_; i > 0; --i) {
+      auto *slot = reinterpret_cast<Slot *>(block + (i - 1) * slot_size_);
+      slot->next = free_list_;
+      free_list_ = slot;
+    }
+  }
+
+  void FreeBlocks() {
+    for (char *block : blocks_) ::operator delete(block);
+    blocks_.clear();
+    free_list_ = nullptr;
+  }
+
+  size_type block_slots_;
+  size_type slot_size_ = 0;
+  size_type allocated_ = 0;
+  Slot *free_list_ = nullptr;
+  std::vector<char *> blocks_;
+};
+
+// Allocator that serves single-object requests from a shared NodePool, so
+// tree nodes come from a few contiguous blocks instead of one malloc each.
+// A default-constructed allocator owns a fresh pool; copies and rebound
+// copies share it, which lets several containers draw from one pool.
+// Requests for arrays or over-aligned types go to operator new.
+template <class T, std::size_t BlockSlots = 256>
+class PoolAllocator {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  template <class U>
+  struct rebind {
+    using other = PoolAllocator<U, BlockSlots>;
+  };
+
+  PoolAllocator() : pool_(std::make_shared<NodePool>(BlockSlots)) {}
+
+  template <class U>
+  PoolAllocator(const PoolAllocator<U, BlockSlots> &other)
+      : pool_(other.pool_) {}
+
+  T *allocate(size_type n) {
+    if (n == 1 && pool_->Fits(sizeof(T), alignof(T))) {
+      return static_cast<T *>(pool_->Allocate(sizeof(T)));
+    }
+    if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return static_cast<T *>(
+          ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T *ptr, size_type n) {
+    if (n == 1 && pool_->Fits(sizeof(T), alignof(T))) {
+      pool_->Deallocate(ptr);
+    } else if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(ptr, std::align_val_t(alignof(T)));
+    } else {
+      ::operator delete(ptr);
+    }
+  }
+
+  bool release() { return pool_->Release(); }
+
+  size_type allocated() const { return pool_->allocated(); }
+  size_type capacity() const { return pool_->capacity(); }
+  size_type blocks() const { return pool_->blocks(); }
+
+  template <class U>
+  bool operator==(const PoolAllocator<U, BlockSlots> &other) const {
+    return pool_ == other.pool_;
+  }
+
+  template <class U>
+  bool operator!=(const PoolAllocator<U, BlockSlots> &other) const {
+    return pool_ != other.pool_;
+  }
+
+ private:
+  std::shared_ptr<NodePool> pool_;
+
+  template <class U, std::size_t>
+  friend class PoolAllocator;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_POOL_ALLOCATOR_H_
@@ -0,0 +1,274 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_RUN_LENGTH_TREE_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_RUN_LENGTH_TREE_H_
+
+#include "s21_tree.h"
+
+namespace s21 {
+// Multiset backend that keeps one (key, count) node per distinct key, so
+// memory grows with the number of distinct keys rather than elements.
+// Iteration still yields every copy. Erasing a copy lowers its count and
+// may invalidate iterators to later copies of the same key. Node handles
+// and the order statistics of BinaryTree are not available.
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>>
+class RunLengthTree {
+ public:
+  using key_type = K;
+  using value_type = K;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using run_type = std::pair<const K, size_type>;
+  using tree_type =
+      BinaryTree<run_type, MapCompare<K, size_type, Compare>,
+                 typename std::allocator_traits<
+                     Allocator>::template rebind_alloc<run_type>>;
+  using node_type = typename tree_type::node_type;
+  using RunNode = typename tree_type::BTNode;
+
+  // Walks a run copy by copy before moving on to the next node.
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const K *;
+    using reference = const K &;
+
+    Iterator() {}
+    Iterator(RunNode *node, size_type index) : node_(node), index_(index) {}
+
+    const K &operator*() const { return node_->val.first; }
+
+    Iterator &operator++() {
+      if (++index_ == node_->val.second) {
+        node_ = (++typename tree_type::iterator(node_)).get();
+        index_ = 0;
+      }
+      return *this;
+    }
+
+    Iterator &operator--() {
+      if (index_ == 0) {
+        node_ = (--typename tree_type::iterator(node_)).get();
+        index_ = node_->val.second;
+      }
+      --index_;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    Iterator operator--(int) {
+      Iterator prev = *this;
+      --*this;
+      return prev;
+    }
+
+    bool operator==(const Iterator &other) const {
+      return node_ == other.node_ && index_ == other.index_;
+    }
+
+    bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+   private:
+    RunNode *node_ = nullptr;
+    size_type index_ = 0;
+
+    friend class RunLengthTree;
+  };
+
+  using ConstIterator = Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+  RunLengthTree() {}
+
+  explicit RunLengthTree(const Compare &comp,
+                         const Allocator &alloc = Allocator())
+      : tree_(MapCompare<K, size_type, Compare>(comp), RunAllocator(alloc)) {}
+
+  explicit RunLengthTree(const Allocator &alloc)
+      : tree_(RunAllocator(alloc)) {}
+
+  RunLengthTree(const RunLengthTree &other)
+      : tree_(other.tree_), total_(other.total_) {}
+
+  RunLengthTree(RunLengthTree &&other) noexcept
+      : tree_(std::move(other.tree_)),
+        total_(std::exchange(other.total_, 0)) {}
+
+  RunLengthTree &operator=(RunLengthTree &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  iterator begin() const { return MakeIterator(tree_.begin().get()); }
+
+  iterator end() const { return MakeIterator(tree_.end().get()); }
+
+  bool empty() const { return total_ == 0; }
+
+  size_type size() const { return total_; }
+
+  // Number of nodes, one per distinct key.
+  size_type distinct_size() const { return tree_.size(); }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max();
+  }
+
+  void clear() {
+    tree_.clear();
+    total_ = 0;
+  }
+
+  std::pair<iterator, bool> insert_def(const value_type &value) {
+    return std::make_pair(AddCopies(tree_.end(), value, 1), true);
+  }
+
+  iterator insert_def(const_iterator hint, const value_type &value) {
+    return AddCopies(TreeHint(hint), value, 1);
+  }
+
+  template <class... Args>
+  iterator emplace_def(Args &&...args) {
+    return AddCopies(tree_.end(), K(std::forward<Args>(args)...), 1);
+  }
+
+  template <class... Args>
+  iterator emplace_hint_def(const_iterator hint, Args &&...args) {
+    return AddCopies(TreeHint(hint), K(std::forward<Args>(args)...), 1);
+  }
+
+  // Equal values form one run, so the input only has to be counted.
+  template <class InputIt>
+  void assign_sorted_def(InputIt first, InputIt last) {
+    std::vector<K> keys(first, last);
+    Compare less = key_comp();
+    if (!std::is_sorted(keys.begin(), keys.end(), less)) {
+      std::sort(keys.begin(), keys.end(), less);
+    }
+    std::vector<std::pair<K, size_type>> runs;
+    for (auto &key : keys) {
+      if (runs.empty() || less(runs.back().first, key)) {
+        runs.emplace_back(std::move(key), 1);
+      } else {
+        ++runs.back().second;
+      }
+    }
+    tree_.assign_sorted(runs.begin(), runs.end());
+    total_ = keys.size();
+  }
+
+  // Removes one copy; the node goes once its count drops to zero.
+  void erase(iterator pos) {
+    if (pos.node_->is_fake) throw std::out_of_range("List is empty");
+    if (--pos.node_->val.second == 0) {
+      tree_.erase(typename tree_type::iterator(pos.node_));
+    }
+    --total_;
+  }
+
+  void swap(RunLengthTree &other) {
+    tree_.swap(other.tree_);
+    std::swap(total_, other.total_);
+  }
+
+  // Keys missing here move over with their nodes; the counts of the others
+  // are added up.
+  void merge_multiset(RunLengthTree &other) {
+    if (this == &other) return;
+    tree_.merge(other.tree_);
+    for (auto it = other.tree_.begin(); it != other.tree_.end(); ++it) {
+      tree_.FindNode(it.get()->val.first)->val.second += it.get()->val.second;
+    }
+    total_ += other.total_;
+    other.clear();
+  }
+
+  iterator find(const key_type &key) const {
+    return MakeIterator(tree_.FindNode(key));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) const {
+    return MakeIterator(tree_.FindNode(key));
+  }
+
+  bool contains(const key_type &key) const { return tree_.contains(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return tree_.contains(key);
+  }
+
+  size_type count(const key_type &key) const { return CountOf(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return CountOf(key);
+  }
+
+  iterator lower_bound(const key_type &key) const {
+    return MakeIterator(tree_.lower_bound(key).get());
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) const {
+    return MakeIterator(tree_.lower_bound(key).get());
+  }
+
+  iterator upper_bound(const key_type &key) const {
+    return MakeIterator(tree_.upper_bound(key).get());
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) const {
+    return MakeIterator(tree_.upper_bound(key).get());
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+
+  allocator_type get_allocator() const {
+    return allocator_type(tree_.get_allocator());
+  }
+
+ private:
+  using RunAllocator = typename tree_type::allocator_type;
+
+  static iterator MakeIterator(const RunNode *node) {
+    return iterator(const_cast<RunNode *>(node), 0);
+  }
+
+  // The fake end node that FindNode returns for a missing key holds no
+  // count of its own.
+  template <class Key>
+  size_type CountOf(const Key &key) const {
+    const RunNode *node = tree_.FindNode(key);
+    return node->is_fake ? 0 : node->val.second;
+  }
+
+  static typename tree_type::const_iterator TreeHint(const_iterator hint) {
+    return typename tree_type::const_iterator(hint.node_);
+  }
+
+  // Adds copies of key, returning an iterator to the last of them.
+  iterator AddCopies(typename tree_type::const_iterator hint, const K &key,
+                     size_type copies) {
+    RunNode *node = tree_.try_emplace_hint(hint, key, key, 0).get();
+    node->val.second += copies;
+    total_ += copies;
+    return iterator(node, node->val.second - 1);
+  }
+
+  tree_type tree_;
+  size_type total_ = 0;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_RUN_LENGTH_TREE_H_
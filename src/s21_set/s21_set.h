@@ -1,27 +1,48 @@
 #ifndef CPP2_S21_CONTAINERS_1_SRC_S21_SET_H_
 #define CPP2_S21_CONTAINERS_1_SRC_S21_SET_H_
 
+#include "../s21_btree.h"
+#include "../s21_frozen.h"
+#include "../s21_persistent.h"
+#include "../s21_pool_allocator.h"
+#include "../s21_skip_list.h"
 #include "../s21_tree.h"
 
 namespace s21 {
-template <class Key, class Container = BinaryTree<Key, std::less<Key>>>
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>,
+          class Container = BinaryTree<Key, Compare, Allocator>>
 class Set {
  public:
   using key_type = Key;
   using value_type = Key;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
   using reference = value_type &;
   using const_reference = const value_type &;
   using iterator = typename Container::Iterator;
   using const_iterator = typename Container::ConstIterator;
   using size_type = std::size_t;
+  using node_type = typename Container::node_type;
+  using insert_return_type = typename Container::insert_return_type;
 
   Set() {}
+  explicit Set(const Compare &comp, const Allocator &alloc = Allocator())
+      : bt_(comp, alloc) {}
+  explicit Set(const Allocator &alloc) : bt_(alloc) {}
   Set(std::initializer_list<value_type> const &items) {
-    for (auto item : items) {
-      bt_.insert(item);
-    }
+    bt_.assign_sorted(items.begin(), items.end());
+  }
+  template <class InputIt, class = typename std::iterator_traits<
+                               InputIt>::iterator_category>
+  Set(InputIt first, InputIt last) {
+    bt_.assign_sorted(first, last);
+  }
+  // Builds on threads from a random access range, see Parallel.
+  template <class InputIt>
+  Set(Parallel policy, InputIt first, InputIt last) {
+    bt_.assign_sorted(first, last, policy);
   }
-
   Set(const Set &s) : bt_(s.bt_) {}
   Set(Set &&s) : bt_(std::move(s.bt_)) {}
   ~Set() {}
@@ -31,7 +52,7 @@ class Set {
   }
 
   Set &operator=(Set &s) {
-    s21::Set<value_type> copy(s);
+    Set copy(s);
     *this = std::move(copy);
     return *this;
   }
@@ -52,20 +73,162 @@ class Set {
     return bt_.insert(value);
   }
 
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return bt_.insert(std::move(value));
+  }
+
+  iterator insert(const_iterator hint, const value_type &value) {
+    return bt_.insert(hint, value);
+  }
+
+  iterator insert(const_iterator hint, value_type &&value) {
+    return bt_.insert(hint, std::move(value));
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return bt_.emplace(std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return bt_.emplace_hint(hint, std::forward<Args>(args)...);
+  }
+
+  insert_return_type insert(node_type &&node) {
+    return bt_.insert(std::move(node));
+  }
+
   void erase(iterator pos) { bt_.erase(pos); }
 
+  node_type extract(iterator pos) { return bt_.extract(pos); }
+  node_type extract(const Key &key) { return bt_.extract(key); }
+
   void swap(Set &other) { bt_.swap(other.bt_); }
 
   void merge(Set &other) { bt_.merge(other.bt_); }
+  void merge(Set &other, Parallel policy) { bt_.merge(other.bt_, policy); }
+
+  // Moves the elements not less than key into the returned set; those
+  // less than key stay. O(log n) with the default tree.
+  Set split(const Key &key) {
+    Set high(key_comp(), get_allocator());
+    high.bt_ = bt_.split(key);
+    return high;
+  }
+
+  // Moves all of other into this set in O(log n) when its keys all go
+  // after, or all before, the keys here. Throws std::invalid_argument if
+  // the ranges overlap.
+  void join(Set &other) { bt_.join(other.bt_); }
+
+  // New sets built in one ordered pass over both operands, see
+  // BinaryTree::set_union; the result takes this set's allocator.
+  Set set_union(const Set &other) const {
+    return Set(bt_.set_union(other.bt_));
+  }
+
+  Set set_intersection(const Set &other) const {
+    return Set(bt_.set_intersection(other.bt_));
+  }
+
+  Set set_difference(const Set &other) const {
+    return Set(bt_.set_difference(other.bt_));
+  }
+
+  Set set_symmetric_difference(const Set &other) const {
+    return Set(bt_.set_symmetric_difference(other.bt_));
+  }
+
+  // The same on threads, see Parallel; BinaryTree containers only.
+  Set set_union(const Set &other, Parallel policy) const {
+    return Set(bt_.set_union(other.bt_, policy));
+  }
+
+  Set set_intersection(const Set &other, Parallel policy) const {
+    return Set(bt_.set_intersection(other.bt_, policy));
+  }
+
+  Set set_difference(const Set &other, Parallel policy) const {
+    return Set(bt_.set_difference(other.bt_, policy));
+  }
+
+  Set set_symmetric_difference(const Set &other, Parallel policy) const {
+    return Set(bt_.set_symmetric_difference(other.bt_, policy));
+  }
 
   iterator find(const Key &key) { return bt_.find(key); }
   const_iterator find(const Key &key) const { return bt_.find(key); }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  iterator find(const K &key) {
+    return bt_.find(key);
+  }
+
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const K &key) const {
+    return bt_.find(key);
+  }
+
+  // Calls fn on every element in order. With a SkipList container this,
+  // unlike stepping an iterator, is safe while other threads erase.
+  template <class Fn>
+  void for_each(Fn fn) const { bt_.for_each(fn); }
+
   bool contains(const Key &key) const { return bt_.contains(key); }
 
+  template <class K, class C = Compare, class = typename C::is_transparent>
+  bool contains(const K &key) const {
+    return bt_.contains(key);
+  }
+
+  iterator nth(size_type k) { return bt_.nth(k); }
+  const_iterator nth(size_type k) const { return bt_.nth(k); }
+
+  size_type rank(const Key &key) const { return bt_.rank(key); }
+
+  size_type count_range(const Key &lo, const Key &hi) const {
+    return bt_.count_range(lo, hi);
+  }
+
+  key_compare key_comp() const { return bt_.key_comp(); }
+
+  allocator_type get_allocator() const { return bt_.get_allocator(); }
+
+  // Read-only copy laid out for lookups, see EytzingerTree.
+  FrozenSet<Key, Compare, Allocator> freeze() const {
+    return FrozenSet<Key, Compare, Allocator>(begin(), end(), key_comp(),
+                                              get_allocator());
+  }
+
+  // Copy of the set as it is now. With a PersistentTree it shares every
+  // node with this set and takes O(1); other containers copy the values.
+  Set snapshot() const { return *this; }
+
  private:
+  explicit Set(Container &&bt) : bt_(std::move(bt)) {}
+
   Container bt_;
 };
+
+// Set kept in a B+ tree: wide, cache-line aligned nodes instead of one node
+// per element.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using BTreeSet =
+    Set<Key, Compare, Allocator, BPlusTree<Key, Compare, Allocator>>;
+
+// Set whose copies and snapshots share nodes until either side changes.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using PersistentSet =
+    Set<Key, Compare, Allocator, PersistentTree<Key, Compare, Allocator>>;
+
+// Set that many threads may search and change at once without locks.
+template <class Key, class Compare = std::less<Key>,
+          class Allocator = std::allocator<Key>>
+using SkipListSet =
+    Set<Key, Compare, Allocator, SkipList<Key, Compare, Allocator>>;
 }  // namespace s21
 
 #endif  // CPP2_S21_CONTAINERS_1_SRC_S21_SET_H_
@@ -0,0 +1,819 @@
+#ifndef CPP2_S21_CONTAINERS_1_SRC_S21_SKIP_LIST_H_
+#define CPP2_S21_CONTAINERS_1_SRC_S21_SKIP_LIST_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "s21_epoch.h"
+#include "s21_tree.h"
+
+namespace s21 {
+// Lock-free skip list with the interface of BinaryTree, usable as the
+// Container of Set, Multiset and Map. Lookups, inserts, erase and extract
+// may run on any number of threads at once; each link is changed with one
+// compare-and-swap. An erased node first has its links marked, so that
+// nothing can be linked after it, and is then unlinked by whichever search
+// passes it. It is freed through an epoch domain once no thread can reach
+// it any more. The allocator has to be safe to call from several threads,
+// as std::allocator is.
+//
+// Iterators hold no guard, so the node an iterator points at may be freed
+// as soon as another thread erases it: stepping one is safe only while no
+// other thread erases. for_each walks the elements under one guard and is
+// safe against concurrent erase. Nodes have no back links, so operator--
+// costs a search. clear, swap, merge, assignment and the builders are not
+// safe against concurrent calls. Equal elements of a multiset come in no
+// particular order. There are no order statistics (nth, rank,
+// count_range).
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>>
+class SkipList : private EmptyBaseHolder<Compare, 0>,
+                 private EmptyBaseHolder<Allocator, 1> {
+ public:
+  using key_type = typename KeyOfValue<K, Compare>::type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using value_type = K;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+  using size_type = size_t;
+  using node_type = NodeHandle<K, TreeNodeAllocator<K, Allocator>>;
+
+ private:
+  // A link holds the next node on its level; the low bit marks the node
+  // that owns the link as erased.
+  using Link = std::atomic<uintptr_t>;
+
+  // The height links of a node follow it in the same allocation. owners
+  // counts the inserter, while it is still linking upper levels, and the
+  // eraser: whichever lets go last unlinks the node for good.
+  struct Node {
+    template <class... Args>
+    explicit Node(int levels, Args &&...args)
+        : height(levels), val(std::forward<Args>(args)...) {}
+
+    alignas(Link) std::atomic<int> owners{2};
+    int height;
+    K val;
+  };
+
+  // A quarter of the nodes reach each next level, which is enough for
+  // 4^16 elements.
+  static constexpr int kMaxLevel = 16;
+  static constexpr uintptr_t kMark = 1;
+
+ public:
+  template <bool IsConst>
+  class ListIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<IsConst || std::is_same_v<key_type, K>, const K &,
+                           K &>;
+    using pointer = std::remove_reference_t<reference> *;
+
+    ListIterator() = default;
+    ListIterator(const SkipList *list, Node *node)
+        : list_(list), node_(node) {}
+
+    template <bool C = IsConst, class = std::enable_if_t<C>>
+    ListIterator(const ListIterator<false> &other)
+        : list_(other.list_), node_(other.node_) {}
+
+    reference operator*() const { return node_->val; }
+    pointer operator->() const { return &node_->val; }
+
+    ListIterator &operator++() {
+      node_ = list_->Next(node_);
+      return *this;
+    }
+
+    ListIterator &operator--() {
+      node_ = list_->Prev(node_);
+      return *this;
+    }
+
+    ListIterator operator++(int) {
+      ListIterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    ListIterator operator--(int) {
+      ListIterator prev = *this;
+      --*this;
+      return prev;
+    }
+
+    bool operator==(const ListIterator &other) const {
+      return node_ == other.node_;
+    }
+
+    bool operator!=(const ListIterator &other) const {
+      return node_ != other.node_;
+    }
+
+   private:
+    const SkipList *list_ = nullptr;
+    Node *node_ = nullptr;
+
+    template <bool>
+    friend class ListIterator;
+    friend class SkipList;
+  };
+
+  using Iterator = ListIterator<false>;
+  using ConstIterator = ListIterator<true>;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+  using insert_return_type = InsertReturnType<iterator, node_type>;
+
+  SkipList() {}
+
+  explicit SkipList(const Compare &comp, const Allocator &alloc = Allocator())
+      : CompareBase(comp), AllocatorBase(alloc) {}
+
+  explicit SkipList(const Allocator &alloc) : SkipList(Compare(), alloc) {}
+
+  SkipList(std::initializer_list<value_type> const &items) : SkipList() {
+    assign_sorted(items.begin(), items.end());
+  }
+
+  SkipList(const SkipList &other)
+      : SkipList(other.key_comp(),
+                 std::allocator_traits<Allocator>::
+                     select_on_container_copy_construction(
+                         other.get_allocator())) {
+    const_iterator it = other.begin();
+    BuildSorted(other.size(), [&it]() -> const K & { return *it++; });
+  }
+
+  SkipList(SkipList &&other) noexcept
+      : SkipList(other.key_comp(), other.get_allocator()) {
+    swap(other);
+  }
+
+  ~SkipList() { clear(); }
+
+  SkipList &operator=(SkipList &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  iterator begin() { return iterator(this, First()); }
+  iterator end() { return iterator(this, nullptr); }
+  const_iterator begin() const { return const_iterator(this, First()); }
+  const_iterator end() const { return const_iterator(this, nullptr); }
+
+  bool empty() const { return size() == 0; }
+
+  size_type size() const { return size_.load(std::memory_order_relaxed); }
+
+  size_type max_size() const {
+    return std::numeric_limits<size_type>::max() /
+           (sizeof(Node) + sizeof(Link));
+  }
+
+  // Calls fn on every element in order under one guard, so no node is
+  // freed during the walk even when other threads erase it. Elements
+  // inserted or erased meanwhile may or may not be seen.
+  template <class Fn>
+  void for_each(Fn fn) const {
+    EpochDomain::Guard guard(domain_);
+    for (Node *node = FirstAfter(head_); node;
+         node = FirstAfter(Links(node))) {
+      fn(static_cast<const_reference>(node->val));
+    }
+  }
+
+  void clear() {
+    domain_.Flush();
+    Node *node = Ptr(head_[0].load(std::memory_order_relaxed));
+    while (node) {
+      Node *next = Ptr(Links(node)[0].load(std::memory_order_relaxed));
+      DeleteNode(node);
+      node = next;
+    }
+    for (Link &link : head_) link.store(0, std::memory_order_relaxed);
+    size_.store(0, std::memory_order_relaxed);
+    levels_.store(1, std::memory_order_relaxed);
+  }
+
+  // Erased nodes still waiting for their epoch are freed first, while the
+  // allocators are still their own.
+  void swap(SkipList &other) {
+    domain_.Flush();
+    other.domain_.Flush();
+    std::swap(comp(), other.comp());
+    std::swap(alloc(), other.alloc());
+    for (int level = 0; level < kMaxLevel; ++level) {
+      head_[level].store(other.head_[level].exchange(
+          head_[level].load(std::memory_order_relaxed)));
+    }
+    size_.store(other.size_.exchange(size_.load()));
+    levels_.store(other.levels_.exchange(levels_.load()));
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return InsertUnique(KeyOf(value), value);
+  }
+
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return InsertUnique(KeyOf(value), std::move(value));
+  }
+
+  std::pair<iterator, bool> insert_def(const value_type &value) {
+    return std::make_pair(emplace_def(value), true);
+  }
+
+  // Every insert searches from the head, so hints are accepted for
+  // compatibility and otherwise ignored.
+  iterator insert(const_iterator, const value_type &value) {
+    return insert(value).first;
+  }
+
+  iterator insert(const_iterator, value_type &&value) {
+    return insert(std::move(value)).first;
+  }
+
+  iterator insert_def(const_iterator, const value_type &value) {
+    return emplace_def(value);
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    using ArgsKey = EmplaceKey<key_type, value_type, std::decay_t<Args>...>;
+    if constexpr (ArgsKey::value) {
+      return InsertUnique(ArgsKey::Get(args...), std::forward<Args>(args)...);
+    } else {
+      value_type value(std::forward<Args>(args)...);
+      return InsertUnique(KeyOf(value), std::move(value));
+    }
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator, Args &&...args) {
+    return emplace(std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace_key(const key_type &key,
+                                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace_hint(const_iterator, const key_type &key,
+                            Args &&...args) {
+    return InsertUnique(key, std::forward<Args>(args)...).first;
+  }
+
+  template <class... Args>
+  iterator emplace_def(Args &&...args) {
+    EpochDomain::Guard guard(domain_);
+    Node *node = NewNode(RandomHeight(), std::forward<Args>(args)...);
+    return LinkNode(guard, node, false).first;
+  }
+
+  template <class... Args>
+  iterator emplace_hint_def(const_iterator, Args &&...args) {
+    return emplace_def(std::forward<Args>(args)...);
+  }
+
+  // Links the nodes level by level in O(n) when [first, last) is sorted;
+  // otherwise the range is sorted first. Keeps the first of equal values.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    AssignSorted(first, last, true);
+  }
+
+  template <class InputIt>
+  void assign_sorted_def(InputIt first, InputIt last) {
+    AssignSorted(first, last, false);
+  }
+
+  // Moves the values whose keys are missing here out of other.
+  void merge(SkipList &other) {
+    if (this == &other) return;
+    for (iterator it = other.begin(); it != other.end();) {
+      iterator pos = it++;
+      if (InsertUnique(KeyOf(*pos), std::move(*pos)).second) {
+        other.erase(pos);
+      }
+    }
+  }
+
+  void merge_multiset(SkipList &other) {
+    if (this == &other) return;
+    for (iterator it = other.begin(); it != other.end(); ++it) {
+      emplace_def(std::move(*it));
+    }
+    other.clear();
+  }
+
+  iterator find(const key_type &key) { return FindPos<iterator>(key); }
+
+  const_iterator find(const key_type &key) const {
+    return FindPos<const_iterator>(key);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) {
+    return FindPos<iterator>(key);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const Key &key) const {
+    return FindPos<const_iterator>(key);
+  }
+
+  iterator lower_bound(const key_type &key) {
+    return BoundPos<iterator>(key, false);
+  }
+
+  const_iterator lower_bound(const key_type &key) const {
+    return BoundPos<const_iterator>(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) {
+    return BoundPos<iterator>(key, false);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key &key) const {
+    return BoundPos<const_iterator>(key, false);
+  }
+
+  iterator upper_bound(const key_type &key) {
+    return BoundPos<iterator>(key, true);
+  }
+
+  const_iterator upper_bound(const key_type &key) const {
+    return BoundPos<const_iterator>(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) {
+    return BoundPos<iterator>(key, true);
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key &key) const {
+    return BoundPos<const_iterator>(key, true);
+  }
+
+  size_type count(const key_type &key) const { return CountValues(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return CountValues(key);
+  }
+
+  bool contains(const key_type &key) const { return HasKey(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return HasKey(key);
+  }
+
+  key_compare key_comp() const { return comp(); }
+
+  allocator_type get_allocator() const { return alloc(); }
+
+  // When several threads erase the same element, one of them does.
+  void erase(iterator pos) {
+    if (pos == end()) throw std::out_of_range("List is empty");
+    EpochDomain::Guard guard(domain_);
+    if (MarkErased(pos.node_)) Release(guard, pos.node_);
+  }
+
+  // The value is copied, not moved, as other threads may still be reading
+  // it. Returns an empty node if another thread erased the element first.
+  node_type extract(iterator pos) {
+    if (pos == end()) return node_type();
+    NodeAllocator node_alloc(alloc());
+    TreeNode<K> *handle = HandleTraits::allocate(node_alloc, 1);
+    try {
+      HandleTraits::construct(node_alloc, handle, std::in_place,
+                              std::as_const(pos.node_->val));
+    } catch (...) {
+      HandleTraits::deallocate(node_alloc, handle, 1);
+      throw;
+    }
+    node_type result(handle, node_alloc);
+    EpochDomain::Guard guard(domain_);
+    if (!MarkErased(pos.node_)) return node_type();
+    Release(guard, pos.node_);
+    return result;
+  }
+
+  node_type extract(const key_type &key) { return extract(find(key)); }
+
+  insert_return_type insert(node_type &&node) {
+    if (node.empty()) return {end(), false, node_type()};
+    auto result = InsertUnique(KeyOf(node.value()), std::move(node.value()));
+    if (!result.second) return {result.first, false, std::move(node)};
+    node.reset();
+    return {result.first, true, node_type()};
+  }
+
+  iterator insert_def(node_type &&node) {
+    if (node.empty()) return end();
+    iterator pos = emplace_def(std::move(node.value()));
+    node.reset();
+    return pos;
+  }
+
+ private:
+  using CompareBase = EmptyBaseHolder<Compare, 0>;
+  using AllocatorBase = EmptyBaseHolder<Allocator, 1>;
+  using NodeTraits = typename std::allocator_traits<
+      Allocator>::template rebind_traits<Node>;
+  using NodeAllocator = TreeNodeAllocator<K, Allocator>;
+  using HandleTraits = std::allocator_traits<NodeAllocator>;
+
+  const Compare &comp() const { return CompareBase::get(); }
+  Compare &comp() { return CompareBase::get(); }
+  const Allocator &alloc() const { return AllocatorBase::get(); }
+  Allocator &alloc() { return AllocatorBase::get(); }
+
+  static const key_type &KeyOf(const value_type &value) {
+    return KeyOfValue<K, Compare>::Get(value);
+  }
+
+  template <class Lhs, class Rhs>
+  bool Less(const Lhs &lhs, const Rhs &rhs) const {
+    return comp()(lhs, rhs);
+  }
+
+  static Link *Links(Node *node) { return reinterpret_cast<Link *>(node + 1); }
+
+  static Node *NodeOf(Link *links) {
+    return reinterpret_cast<Node *>(links) - 1;
+  }
+
+  static Node *Ptr(uintptr_t link) {
+    return reinterpret_cast<Node *>(link & ~kMark);
+  }
+
+  static uintptr_t Word(Node *node) {
+    return reinterpret_cast<uintptr_t>(node);
+  }
+
+  static bool Marked(uintptr_t link) { return link & kMark; }
+
+  // Nodes are allocated as runs of Node-sized units to make room for the
+  // links.
+  static size_type Units(int height) {
+    return 1 + (height * sizeof(Link) + sizeof(Node) - 1) / sizeof(Node);
+  }
+
+  // Each level is kept with probability 1/4, two random bits at a time.
+  static int RandomHeight() {
+    thread_local uint64_t state =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    int height = 1;
+    for (uint64_t bits = state; height < kMaxLevel && (bits & 3) == 0;
+         bits >>= 2) {
+      ++height;
+    }
+    return height;
+  }
+
+  template <class... Args>
+  Node *NewNode(int height, Args &&...args) {
+    typename NodeTraits::allocator_type node_alloc(alloc());
+    Node *node = NodeTraits::allocate(node_alloc, Units(height));
+    try {
+      NodeTraits::construct(node_alloc, node, height,
+                            std::forward<Args>(args)...);
+    } catch (...) {
+      NodeTraits::deallocate(node_alloc, node, Units(height));
+      throw;
+    }
+    for (int level = 0; level < height; ++level) {
+      new (Links(node) + level) Link(0);
+    }
+    return node;
+  }
+
+  void DeleteNode(Node *node) {
+    typename NodeTraits::allocator_type node_alloc(alloc());
+    size_type units = Units(node->height);
+    NodeTraits::destroy(node_alloc, node);
+    NodeTraits::deallocate(node_alloc, node, units);
+  }
+
+  static void FreeRetired(void *node, void *list) {
+    static_cast<SkipList *>(list)->DeleteNode(static_cast<Node *>(node));
+  }
+
+  void RaiseLevels(int height) {
+    int levels = levels_.load(std::memory_order_relaxed);
+    while (levels < height &&
+           !levels_.compare_exchange_weak(levels, height)) {
+    }
+  }
+
+  // Replaces node at link with its successor next, if link still leads
+  // to node.
+  static bool Snip(Link &link, Node *node, uintptr_t next) {
+    uintptr_t expected = Word(node);
+    return link.compare_exchange_strong(expected, next & ~kMark);
+  }
+
+  // Walks down from the head to the last node for which before() holds,
+  // passing over erased nodes without unlinking them; the head if there is
+  // none. succ is set to the node after it. The caller holds a guard.
+  template <class Before>
+  Link *Descend(Before before, Node *&succ) const {
+    Link *pred = head_;
+    Node *curr = nullptr;
+    for (int level = levels_.load(std::memory_order_acquire) - 1; level >= 0;
+         --level) {
+      curr = Ptr(pred[level].load(std::memory_order_acquire));
+      while (curr) {
+        uintptr_t next = Links(curr)[level].load(std::memory_order_acquire);
+        if (!Marked(next)) {
+          if (!before(curr)) break;
+          pred = Links(curr);
+        }
+        curr = Ptr(next);
+      }
+    }
+    succ = curr;
+    return pred;
+  }
+
+  // The first node after links on the bottom level that is not erased.
+  static Node *FirstAfter(Link *links) {
+    Node *node = Ptr(links[0].load(std::memory_order_acquire));
+    while (node) {
+      uintptr_t next = Links(node)[0].load(std::memory_order_acquire);
+      if (!Marked(next)) break;
+      node = Ptr(next);
+    }
+    return node;
+  }
+
+  Node *First() const {
+    EpochDomain::Guard guard(domain_);
+    return FirstAfter(head_);
+  }
+
+  Node *Next(Node *node) const {
+    EpochDomain::Guard guard(domain_);
+    return FirstAfter(Links(node));
+  }
+
+  // The node before node, or the last one for end(): the last node with a
+  // smaller key, then forward through the equal ones.
+  Node *Prev(Node *node) const {
+    EpochDomain::Guard guard(domain_);
+    Node *curr = nullptr;
+    if (!node) {
+      Link *last = Descend([](Node *) { return true; }, curr);
+      return last == head_ ? nullptr : NodeOf(last);
+    }
+    Link *pred = Descend(
+        [this, node](Node *other) {
+          return Less(KeyOf(other->val), KeyOf(node->val));
+        },
+        curr);
+    Node *prev = pred == head_ ? nullptr : NodeOf(pred);
+    for (; curr && curr != node && !Less(KeyOf(node->val), KeyOf(curr->val));
+         curr = FirstAfter(Links(curr))) {
+      prev = curr;
+    }
+    return prev;
+  }
+
+  // The first node not less than key, or for upper greater than key. The
+  // caller holds a guard.
+  template <class Key>
+  Node *Bound(const Key &key, bool upper) const {
+    Node *succ = nullptr;
+    Descend(
+        [this, &key, upper](Node *node) {
+          return upper ? !Less(key, KeyOf(node->val))
+                       : Less(KeyOf(node->val), key);
+        },
+        succ);
+    return succ;
+  }
+
+  template <class Pos, class Key>
+  Pos BoundPos(const Key &key, bool upper) const {
+    EpochDomain::Guard guard(domain_);
+    return Pos(this, Bound(key, upper));
+  }
+
+  template <class Pos, class Key>
+  Pos FindPos(const Key &key) const {
+    EpochDomain::Guard guard(domain_);
+    Node *node = Bound(key, false);
+    if (node && Less(key, KeyOf(node->val))) node = nullptr;
+    return Pos(this, node);
+  }
+
+  template <class Key>
+  bool HasKey(const Key &key) const {
+    EpochDomain::Guard guard(domain_);
+    Node *node = Bound(key, false);
+    return node && !Less(key, KeyOf(node->val));
+  }
+
+  template <class Key>
+  size_type CountValues(const Key &key) const {
+    EpochDomain::Guard guard(domain_);
+    size_type count = 0;
+    for (Node *node = Bound(key, false);
+         node && !Less(key, KeyOf(node->val));
+         node = FirstAfter(Links(node))) {
+      ++count;
+    }
+    return count;
+  }
+
+  // Finds on every level the last node before key and the first one not
+  // before it, unlinking erased nodes on the way; with purge also those
+  // among the nodes equal to key. Returns false when a link changed under
+  // it and the search has to start over.
+  bool TrySearch(const key_type &key, Link **preds, Node **succs,
+                 bool purge) {
+    Link *pred = head_;
+    for (int level = kMaxLevel - 1; level >= 0; --level) {
+      Node *curr = Ptr(pred[level].load(std::memory_order_acquire));
+      while (curr) {
+        uintptr_t next = Links(curr)[level].load(std::memory_order_acquire);
+        if (Marked(next)) {
+          if (!Snip(pred[level], curr, next)) return false;
+          curr = Ptr(next);
+        } else if (Less(KeyOf(curr->val), key)) {
+          pred = Links(curr);
+          curr = Ptr(next);
+        } else {
+          break;
+        }
+      }
+      preds[level] = pred;
+      succs[level] = curr;
+      Link *prev = pred;
+      for (Node *scan = curr; purge && scan && !Less(key, KeyOf(scan->val));) {
+        uintptr_t next = Links(scan)[level].load(std::memory_order_acquire);
+        if (Marked(next)) {
+          if (!Snip(prev[level], scan, next)) return false;
+        } else {
+          prev = Links(scan);
+        }
+        scan = Ptr(next);
+      }
+    }
+    return true;
+  }
+
+  void Search(const key_type &key, Link **preds, Node **succs,
+              bool purge = false) {
+    while (!TrySearch(key, preds, succs, purge)) {
+    }
+  }
+
+  // The value is only built once the key is known to be missing. Another
+  // thread may insert the key meanwhile; then the new node is dropped, and
+  // a value moved in from args is lost with it.
+  template <class... Args>
+  std::pair<iterator, bool> InsertUnique(const key_type &key,
+                                         Args &&...args) {
+    EpochDomain::Guard guard(domain_);
+    Node *found = Bound(key, false);
+    if (found && !Less(key, KeyOf(found->val))) {
+      return std::make_pair(iterator(this, found), false);
+    }
+    Node *node = NewNode(RandomHeight(), std::forward<Args>(args)...);
+    return LinkNode(guard, node, true);
+  }
+
+  // Publishes node on the bottom level, which makes it an element, then
+  // links the levels above one by one.
+  std::pair<iterator, bool> LinkNode(EpochDomain::Guard &guard, Node *node,
+                                     bool unique) {
+    const key_type &key = KeyOf(node->val);
+    Link *preds[kMaxLevel];
+    Node *succs[kMaxLevel];
+    for (;;) {
+      Search(key, preds, succs);
+      if (unique && succs[0] && !Less(key, KeyOf(succs[0]->val))) {
+        DeleteNode(node);
+        return std::make_pair(iterator(this, succs[0]), false);
+      }
+      for (int level = 0; level < node->height; ++level) {
+        Links(node)[level].store(Word(succs[level]),
+                                 std::memory_order_relaxed);
+      }
+      uintptr_t expected = Word(succs[0]);
+      if (preds[0][0].compare_exchange_strong(expected, Word(node))) break;
+    }
+    size_.fetch_add(1, std::memory_order_relaxed);
+    RaiseLevels(node->height);
+    for (int level = 1;
+         level < node->height && LinkLevel(node, level, preds, succs);
+         ++level) {
+    }
+    Release(guard, node);
+    return std::make_pair(iterator(this, node), true);
+  }
+
+  // Links node into one upper level. Stops with false once the node is
+  // being erased: nothing more may be linked to it then.
+  bool LinkLevel(Node *node, int level, Link **preds, Node **succs) {
+    for (;;) {
+      uintptr_t link = Links(node)[level].load(std::memory_order_acquire);
+      if (Marked(link)) return false;
+      if (Ptr(link) != succs[level] &&
+          !Links(node)[level].compare_exchange_strong(link,
+                                                      Word(succs[level]))) {
+        return false;
+      }
+      uintptr_t expected = Word(succs[level]);
+      if (preds[level][level].compare_exchange_strong(expected, Word(node))) {
+        return true;
+      }
+      Search(KeyOf(node->val), preds, succs);
+    }
+  }
+
+  // Marks the links of node from the top down. The thread that marks the
+  // bottom one has erased the element.
+  bool MarkErased(Node *node) {
+    for (int level = node->height - 1; level > 0; --level) {
+      uintptr_t link = Links(node)[level].load(std::memory_order_relaxed);
+      while (!Marked(link) &&
+             !Links(node)[level].compare_exchange_weak(link, link | kMark)) {
+      }
+    }
+    uintptr_t link = Links(node)[0].load(std::memory_order_relaxed);
+    while (!Marked(link)) {
+      if (Links(node)[0].compare_exchange_weak(link, link | kMark)) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The last owner unlinks the node from every level it is still on and
+  // retires it.
+  void Release(EpochDomain::Guard &guard, Node *node) {
+    if (node->owners.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    Link *preds[kMaxLevel];
+    Node *succs[kMaxLevel];
+    Search(KeyOf(node->val), preds, succs, true);
+    guard.Retire(node, this, &FreeRetired);
+  }
+
+  template <class InputIt>
+  void AssignSorted(InputIt first, InputIt last, bool unique) {
+    std::vector<K> values;
+    std::vector<K *> order = SortedOrder(first, last, comp(), unique, values);
+    SkipList built(comp(), alloc());
+    size_type i = 0;
+    built.BuildSorted(order.size(), [&order, &i]() -> K && {
+      return std::move(*order[i++]);
+    });
+    swap(built);
+  }
+
+  // Appends n values taken in order from next() to an empty list. Nothing
+  // else can reach the nodes yet, so they start with the eraser as their
+  // only owner.
+  template <class Source>
+  void BuildSorted(size_type n, Source next) {
+    Link *tails[kMaxLevel];
+    for (Link *&tail : tails) tail = head_;
+    for (size_type i = 0; i < n; ++i) {
+      Node *node = NewNode(RandomHeight(), next());
+      node->owners.store(1, std::memory_order_relaxed);
+      for (int level = 0; level < node->height; ++level) {
+        tails[level][level].store(Word(node), std::memory_order_release);
+        tails[level] = Links(node);
+      }
+      size_.fetch_add(1, std::memory_order_relaxed);
+      RaiseLevels(node->height);
+    }
+  }
+
+  mutable Link head_[kMaxLevel] = {};
+  std::atomic<size_type> size_{0};
+  std::atomic<int> levels_{1};
+  mutable EpochDomain domain_;
+};
+}  // namespace s21
+
+#endif  // CPP2_S21_CONTAINERS_1_SRC_S21_SKIP_LIST_H_
@@ -1,33 +1,327 @@
 #ifndef CPP2_S21_CONTAINERS_1_SRC_S21_TREE_H_
 #define CPP2_S21_CONTAINERS_1_SRC_S21_TREE_H_
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "s21_parallel.h"
 
 namespace s21 {
-template <class K, class Compare = std::less<K>>
-class BinaryTree {
+// Picks the key out of a stored value. A comparator that declares key_type
+// and a static KeyOf() makes the tree order and search values by that key
+// (Map compares pairs by first this way); otherwise the value is the key.
+template <class V, class Compare, class = void>
+struct KeyOfValue {
+  using type = V;
+  static const V &Get(const V &value) { return value; }
+};
+
+template <class V, class Compare>
+struct KeyOfValue<V, Compare, std::void_t<typename Compare::key_type>> {
+  using type = typename Compare::key_type;
+  static const type &Get(const V &value) { return Compare::KeyOf(value); }
+};
+
+// Copies [first, last) into values and returns pointers to them in key
+// order: sorted input is left as it is, other input is sorted stably, and
+// with unique only the first of equal keys stays. The bulk builders of the
+// containers build from this order.
+template <class K, class Compare, class InputIt>
+std::vector<K *> SortedOrder(InputIt first, InputIt last,
+                             const Compare &comp, bool unique,
+                             std::vector<K> &values) {
+  for (; first != last; ++first) values.emplace_back(*first);
+  std::vector<K *> order;
+  order.reserve(values.size());
+  for (K &value : values) order.push_back(&value);
+  auto less = [&comp](const K *lhs, const K *rhs) {
+    return comp(KeyOfValue<K, Compare>::Get(*lhs),
+                KeyOfValue<K, Compare>::Get(*rhs));
+  };
+  if (!std::is_sorted(order.begin(), order.end(), less)) {
+    std::stable_sort(order.begin(), order.end(), less);
+  }
+  if (unique) {
+    order.erase(std::unique(order.begin(), order.end(),
+                            [&less](const K *lhs, const K *rhs) {
+                              return !less(lhs, rhs);
+                            }),
+                order.end());
+  }
+  return order;
+}
+
+// Whether merging m elements into n costs less one search at a time,
+// O(m log n), than in one pass over both, O(n + m).
+inline bool MergeBySearch(size_t n, size_t m) {
+  size_t depth = 1;
+  for (size_t left = n; left > 1; left >>= 1) ++depth;
+  return m * depth < n;
+}
+
+// Orders (key, T) pairs by key alone; the comparator of Map and of the run
+// tree behind CompactMultiset.
+template <class Key, class T, class Compare = std::less<Key>>
+struct MapCompare : Compare {
+  using key_type = Key;
+
+  MapCompare() = default;
+  explicit MapCompare(const Compare &comp) : Compare(comp) {}
+
+  static const Key &KeyOf(const std::pair<const Key, T> &value) {
+    return value.first;
+  }
+};
+
+// Reads the key of the value emplace() would build from arguments of the
+// (decayed) types Args, when that is possible without building the value:
+// a key for sets, a pair or a (key, mapped) list for maps.
+template <class Key, class Value, class... Args>
+struct EmplaceKey : std::false_type {};
+
+template <class Key, class Value, class Arg>
+struct EmplaceKey<Key, Value, Arg>
+    : std::conjunction<std::is_same<Key, Value>, std::is_same<Key, Arg>> {
+  static const Key &Get(const Arg &arg) { return arg; }
+};
+
+template <class Key, class Value, class First, class Second>
+struct EmplaceKey<Key, Value, std::pair<First, Second>>
+    : std::conditional_t<std::is_same_v<Key, Value>,
+                         std::is_same<Key, std::pair<First, Second>>,
+                         std::is_same<Key, std::remove_const_t<First>>> {
+  static const Key &Get(const std::pair<First, Second> &arg) {
+    if constexpr (std::is_same_v<Key, Value>) {
+      return arg;
+    } else {
+      return arg.first;
+    }
+  }
+};
+
+template <class Key, class Value, class First, class Second>
+struct EmplaceKey<Key, Value, First, Second>
+    : std::conjunction<std::negation<std::is_same<Key, Value>>,
+                       std::is_same<Key, First>> {
+  static const Key &Get(const First &first, const Second &) { return first; }
+};
+
+// Base of the tree that holds its comparator or allocator. A stateless one
+// is kept as an empty base, so std::less and std::allocator cost no space.
+template <class T, int Tag,
+          bool = std::is_empty<T>::value && !std::is_final<T>::value>
+class EmptyBaseHolder : private T {
+ public:
+  EmptyBaseHolder() = default;
+  explicit EmptyBaseHolder(const T &value) : T(value) {}
+
+  const T &get() const { return *this; }
+  T &get() { return *this; }
+};
+
+template <class T, int Tag>
+class EmptyBaseHolder<T, Tag, false> {
+ public:
+  EmptyBaseHolder() = default;
+  explicit EmptyBaseHolder(const T &value) : value_(value) {}
+
+  const T &get() const { return value_; }
+  T &get() { return value_; }
+
+ private:
+  T value_;
+};
+
+// Prefetch policies of BinaryTree: whether a descent starts loading both
+// children of a node before comparing with it, and an iterator step the
+// node the next step reads. Grandchildren are not fetched: their address
+// is only known once a child has arrived.
+struct NoPrefetch {
+  static constexpr bool kEnabled = false;
+};
+
+struct PrefetchChildren {
+  static constexpr bool kEnabled = true;
+};
+
+// In-order neighbour links, kept only by threaded trees.
+template <class Node, bool Threaded>
+struct OrderLinks {};
+
+template <class Node>
+struct OrderLinks<Node, true> {
+  Node *prev = nullptr;
+  Node *next = nullptr;
+};
+
+template <class V, bool Threaded = false>
+struct TreeNode : OrderLinks<TreeNode<V, Threaded>, Threaded> {
+  V val = V();
+  TreeNode *left = nullptr;
+  TreeNode *right = nullptr;
+  TreeNode *parent = nullptr;
+  // Nodes in the subtree rooted here, 0 for the fake node. Shares a word
+  // with the flags, so the node is no bigger than with two bools.
+  size_t size : std::numeric_limits<size_t>::digits - 2;
+  size_t is_fake : 1;
+  size_t is_red : 1;
+
+  TreeNode() : size(1), is_fake(false), is_red(true) {}
+
+  template <class... Args>
+  explicit TreeNode(std::in_place_t, Args &&...args)
+      : val(std::forward<Args>(args)...),
+        size(1),
+        is_fake(false),
+        is_red(true) {}
+};
+
+template <class V, class Allocator, bool Threaded = false>
+using TreeNodeAllocator = typename std::allocator_traits<
+    Allocator>::template rebind_alloc<TreeNode<V, Threaded>>;
+
+template <class K, class Compare, class Allocator, bool Threaded,
+          class Prefetch>
+class BinaryTree;
+
+template <class K, class Compare, class Allocator, size_t NodeBytes,
+          class NodeSearch>
+class BPlusTree;
+
+template <class K, class Compare, class Allocator>
+class PersistentTree;
+
+template <class K, class Compare, class Allocator>
+class SkipList;
+
+// Owns a node taken out of a tree by extract() until it is inserted into a
+// tree again. Moving a node this way copies no value and allocates nothing.
+template <class V, class NodeAllocator>
+class NodeHandle {
+ public:
+  using value_type = V;
+  using allocator_type = NodeAllocator;
+  using node_pointer = typename NodeAllocator::value_type *;
+
+  NodeHandle() {}
+  NodeHandle(node_pointer node, const NodeAllocator &alloc)
+      : node_(node), alloc_(alloc) {}
+  NodeHandle(NodeHandle &&other) noexcept
+      : node_(other.node_), alloc_(std::move(other.alloc_)) {
+    other.node_ = nullptr;
+    other.alloc_.reset();
+  }
+  NodeHandle &operator=(NodeHandle &&other) noexcept {
+    if (this != &other) {
+      reset();
+      node_ = other.node_;
+      alloc_ = std::move(other.alloc_);
+      other.node_ = nullptr;
+      other.alloc_.reset();
+    }
+    return *this;
+  }
+  ~NodeHandle() { reset(); }
+
+  bool empty() const { return node_ == nullptr; }
+  explicit operator bool() const { return node_ != nullptr; }
+  allocator_type get_allocator() const { return *alloc_; }
+
+  value_type &value() const { return node_->val; }
+
+  // Map nodes: the key may be changed before the node goes back in.
+  template <class T = V>
+  std::remove_const_t<typename T::first_type> &key() const {
+    return const_cast<std::remove_const_t<typename T::first_type> &>(
+        node_->val.first);
+  }
+
+  template <class T = V>
+  typename T::second_type &mapped() const {
+    return node_->val.second;
+  }
+
+ private:
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
+  void reset() {
+    if (node_) {
+      NodeTraits::destroy(*alloc_, node_);
+      NodeTraits::deallocate(*alloc_, node_, 1);
+      node_ = nullptr;
+    }
+  }
+
+  node_pointer node_ = nullptr;
+  std::optional<NodeAllocator> alloc_;
+
+  template <class, class, class, bool, class>
+  friend class BinaryTree;
+  template <class, class, class, size_t, class>
+  friend class BPlusTree;
+  template <class, class, class>
+  friend class PersistentTree;
+  template <class, class, class>
+  friend class SkipList;
+};
+
+template <class Iterator, class NodeType>
+struct InsertReturnType {
+  Iterator position;
+  bool inserted;
+  NodeType node;
+};
+
+// Red-black tree behind Set, Map and Multiset. A threaded tree also links
+// every node to its in-order neighbours, which makes iterator steps O(1)
+// at the cost of two more pointers per node. Prefetch is one of the
+// policies above; it pays off once the tree outgrows the caches.
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>, bool Threaded = false,
+          class Prefetch = NoPrefetch>
+class BinaryTree
+    : private EmptyBaseHolder<Compare, 0>,
+      private EmptyBaseHolder<TreeNodeAllocator<K, Allocator, Threaded>, 1> {
  public:
-  using key_type = K;
+  using key_type = typename KeyOfValue<K, Compare>::type;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
   using value_type = K;
   using reference = value_type &;
   using const_reference = const value_type &;
   using size_type = size_t;
+  using BTNode = TreeNode<K, Threaded>;
+  using node_type = NodeHandle<K, TreeNodeAllocator<K, Allocator, Threaded>>;
 
+  // Iterators are a bare node pointer: trivially copyable, compared by
+  // identity. Set elements are only reachable as const, like the keys of
+  // Map elements.
   class Iterator {
    public:
-    using tree_node = typename BinaryTree<K>::BTNode;
-
-    Iterator() : ptr_(new BTNode()) {}
+    using tree_node = BTNode;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference =
+        std::conditional_t<std::is_same_v<key_type, K>, const K &, K &>;
+    using pointer = std::remove_reference_t<reference> *;
+
+    Iterator() = default;
     Iterator(tree_node *btNode) : ptr_(btNode) {}
-    Iterator(const Iterator &other) : ptr_(other.ptr_) {}
-    ~Iterator() {
-      if (ptr_) ptr_ = nullptr;
-    }
 
-    tree_node *get() { return ptr_; }
+    tree_node *get() const { return ptr_; }
 
-    value_type operator*() const { return ptr_->val; }
+    reference operator*() const { return ptr_->val; }
+    pointer operator->() const { return &ptr_->val; }
 
     Iterator &operator++() {
       IteratorIncremented();
@@ -51,18 +345,21 @@ class BinaryTree {
       return prev;
     }
 
-    bool operator==(const Iterator &other) { return ptr_ == other.ptr_; }
+    bool operator==(const Iterator &other) const {
+      return ptr_ == other.ptr_;
+    }
 
-    bool operator!=(const Iterator &other) {
-      return (ptr_->is_fake != other.ptr_->is_fake ||
-              ptr_->val != other.ptr_->val);
+    bool operator!=(const Iterator &other) const {
+      return ptr_ != other.ptr_;
     }
 
    protected:
-    tree_node *ptr_;
+    tree_node *ptr_ = nullptr;
 
     void IteratorIncremented() {
-      if (ptr_->right) {
+      if constexpr (Threaded) {
+        ptr_ = ptr_->next;
+      } else if (ptr_->right) {
         ptr_ = ptr_->right;
         while (!ptr_->is_fake && ptr_->left) {
           ptr_ = ptr_->left;
@@ -75,10 +372,13 @@ class BinaryTree {
           ptr_ = ptr_->parent;
         }
       }
+      PrefetchStep(ptr_, true);
     }
 
     void IteratorDecremented() {
-      if (ptr_->left) {
+      if constexpr (Threaded) {
+        ptr_ = ptr_->prev;
+      } else if (ptr_->left) {
         ptr_ = ptr_->left;
         while (!ptr_->is_fake && ptr_->right) {
           ptr_ = ptr_->right;
@@ -91,21 +391,27 @@ class BinaryTree {
           ptr_ = ptr_->parent;
         }
       }
+      PrefetchStep(ptr_, false);
     }
     friend class BinaryTree;
   };
 
   class ConstIterator {
    public:
-    using tree_node = typename BinaryTree<K>::BTNode;
+    using tree_node = BTNode;
     using const_reference = const K &;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = K;
+    using difference_type = std::ptrdiff_t;
+    using reference = const K &;
+    using pointer = const K *;
 
-    ConstIterator() : Iterator() {}
+    ConstIterator() = default;
     explicit ConstIterator(const tree_node *btNode) : ptr_(btNode) {}
     ConstIterator(const Iterator &it) : ptr_(it.ptr_) {}
-    ~ConstIterator() = default;
 
     const_reference operator*() const { return ptr_->val; }
+    pointer operator->() const { return &ptr_->val; }
     const tree_node *get() const { return ptr_; }
 
     ConstIterator &operator++() {
@@ -130,18 +436,21 @@ class BinaryTree {
       return prev;
     }
 
-    bool operator==(const ConstIterator &other) { return ptr_ == other.ptr_; }
+    bool operator==(const ConstIterator &other) const {
+      return ptr_ == other.ptr_;
+    }
 
-    bool operator!=(const ConstIterator &other) {
-      return (ptr_->is_fake != other.ptr_->is_fake ||
-              ptr_->val != other.ptr_->val);
+    bool operator!=(const ConstIterator &other) const {
+      return ptr_ != other.ptr_;
     }
 
    protected:
-    const tree_node *ptr_;
+    const tree_node *ptr_ = nullptr;
 
     void IteratorIncremented() {
-      if (ptr_->right) {
+      if constexpr (Threaded) {
+        ptr_ = ptr_->next;
+      } else if (ptr_->right) {
         ptr_ = ptr_->right;
         while (!ptr_->is_fake && ptr_->left) {
           ptr_ = ptr_->left;
@@ -154,10 +463,13 @@ class BinaryTree {
           ptr_ = ptr_->parent;
         }
       }
+      PrefetchStep(ptr_, true);
     }
 
     void IteratorDecremented() {
-      if (ptr_->left) {
+      if constexpr (Threaded) {
+        ptr_ = ptr_->prev;
+      } else if (ptr_->left) {
         ptr_ = ptr_->left;
         while (!ptr_->is_fake && ptr_->right) {
           ptr_ = ptr_->right;
@@ -170,12 +482,14 @@ class BinaryTree {
           ptr_ = ptr_->parent;
         }
       }
+      PrefetchStep(ptr_, false);
     }
     friend class BinaryTree;
   };
 
   using iterator = Iterator;
   using const_iterator = ConstIterator;
+  using insert_return_type = InsertReturnType<iterator, node_type>;
 
   iterator begin() { return iterator(MinNode(root)); }
 
@@ -190,47 +504,42 @@ class BinaryTree {
 
   size_type size() const { return bt_size; }
 
-  struct BTNode {
-    value_type val = value_type();
-    struct BTNode *left = nullptr;
-    struct BTNode *right = nullptr;
-    struct BTNode *parent = nullptr;
-    bool is_fake = false;
-
-    BTNode() {}
-
-    explicit BTNode(value_type x) : val(x) {}
+  BinaryTree() { MakeRootFake(); }
 
-    BTNode(BTNode &btNode)
-        : val(btNode.val),
-          left(btNode.left),
-          right(btNode.right),
-          parent(btNode.parent) {}
-  };
+  explicit BinaryTree(const Compare &comp,
+                      const Allocator &alloc = Allocator())
+      : CompareBase(comp), AllocatorBase(NodeAllocator(alloc)) {
+    MakeRootFake();
+  }
 
-  BinaryTree() { MakeRootFake(); }
+  explicit BinaryTree(const Allocator &alloc)
+      : BinaryTree(Compare(), alloc) {}
 
   BinaryTree(std::initializer_list<value_type> const &items) : BinaryTree() {
-    for (auto i = items.begin(); i != items.end(); i++) {
-      insert(*i);
-    }
+    assign_sorted(items.begin(), items.end());
   }
 
-  BinaryTree(const BinaryTree &other) : BinaryTree() {
+  BinaryTree(const BinaryTree &other)
+      : BinaryTree(other.key_comp(),
+                   std::allocator_traits<Allocator>::
+                       select_on_container_copy_construction(
+                           other.get_allocator())) {
     clear();
     if (other.bt_size) {
       root = CopyTree(other.root);
       bt_size = other.bt_size;
+      ThreadAll();
     }
   }
 
-  BinaryTree(BinaryTree &&binaryTree) noexcept : BinaryTree() {
+  BinaryTree(BinaryTree &&binaryTree) noexcept
+      : BinaryTree(binaryTree.key_comp(), binaryTree.get_allocator()) {
     swap(binaryTree);
   }
 
   ~BinaryTree() {
     if (!root->is_fake) RemoveNode(root);
-    delete fake_node;
+    DeleteNode(fake_node);
     root = nullptr;
     fake_node = nullptr;
     bt_size = 0;
@@ -242,92 +551,110 @@ class BinaryTree {
   }
 
   std::pair<iterator, bool> insert(const value_type &value) {
-    int insertion_successful = false;
-    if (FindNode(value) != fake_node) {
-      return std::make_pair(end(), insertion_successful);
-    }
+    return TryEmplace(nullptr, KeyOf(value), value);
+  }
 
-    auto *newNode = new BTNode(value);
-    if (root->is_fake) {
-      root = newNode;
-      insertion_successful = true;
-    } else {
-      BTNode *tmp = root;
-      BTNode *result = tmp;
-      while (!insertion_successful && tmp) {
-        if (value < tmp->val) {
-          if (tmp->left) {
-            tmp = tmp->left;
-          } else {
-            tmp->left = newNode;
-            newNode->parent = tmp;
-            insertion_successful = true;
-          }
-        } else if (tmp->val < value) {
-          if (tmp->right && !tmp->right->is_fake) {
-            tmp = tmp->right;
-          } else {
-            tmp->right = newNode;
-            newNode->parent = tmp;
-            insertion_successful = true;
-          }
-        }
-      }
-      root = result;
-    }
-    if (insertion_successful) {
-      ++bt_size;
-      // fake_node->val = value_type(bt_size);
-      InsertFakeNode(root);
-    }
-    return std::make_pair(iterator(newNode), true);
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return TryEmplace(nullptr, KeyOf(value), std::move(value));
   }
 
   std::pair<iterator, bool> insert_def(const value_type &value) {
-    int insertion_successful = false;
+    return std::make_pair(emplace_def(value), true);
+  }
 
-    auto *newNode = new BTNode(value);
-    if (root->is_fake) {
-      root = newNode;
-      insertion_successful = true;
-    } else {
-      BTNode *tmp = root;
-      BTNode *result = tmp;
-      while (!insertion_successful && tmp) {
-        if (value < tmp->val) {
-          if (tmp->left) {
-            tmp = tmp->left;
-          } else {
-            tmp->left = newNode;
-            newNode->parent = tmp;
-            insertion_successful = true;
-          }
-        } else if (tmp->val <= value) {
-          if (tmp->right && !tmp->right->is_fake) {
-            tmp = tmp->right;
-          } else {
-            tmp->right = newNode;
-            newNode->parent = tmp;
-            insertion_successful = true;
-          }
-        }
-      }
-      root = result;
-    }
-    if (insertion_successful) {
-      // fake_node->val = ++bt_size;
-      ++bt_size;
-      InsertFakeNode(root);
-    }
-    return std::make_pair(iterator(newNode), true);
+  // Hinted inserts put the value right before hint when it belongs there
+  // without searching from the root: feeding a sorted stream with end() as
+  // the hint compares each value only with the last one. Linking still
+  // walks up to the root to count the node in the subtree sizes, so an
+  // insert stays O(log n), if cheaper than a search. A wrong hint costs a
+  // normal insert.
+  iterator insert(const_iterator hint, const value_type &value) {
+    return TryEmplace(hint.ptr_, KeyOf(value), value).first;
+  }
+
+  iterator insert(const_iterator hint, value_type &&value) {
+    return TryEmplace(hint.ptr_, KeyOf(value), std::move(value)).first;
+  }
+
+  iterator insert_def(const_iterator hint, const value_type &value) {
+    return emplace_hint_def(hint, value);
+  }
+
+  // Builds the value in place inside a new node. When the key can be read
+  // from args the lookup comes first and nothing is built for a duplicate;
+  // otherwise the node is built, probed and freed again if the key exists.
+  template <class... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return EmplaceUnique(nullptr, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    return EmplaceUnique(hint.ptr_, std::forward<Args>(args)...).first;
+  }
+
+  // Builds a value from args unless key is already present, in which case
+  // args are left untouched.
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace_key(const key_type &key,
+                                            Args &&...args) {
+    return TryEmplace(nullptr, key, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator try_emplace_hint(const_iterator hint, const key_type &key,
+                            Args &&...args) {
+    return TryEmplace(hint.ptr_, key, std::forward<Args>(args)...).first;
+  }
+
+  // Multiset emplace: equal values go after the existing ones, or right
+  // before the hint when it sits among them.
+  template <class... Args>
+  iterator emplace_def(Args &&...args) {
+    return EmplaceMulti(nullptr, std::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  iterator emplace_hint_def(const_iterator hint, Args &&...args) {
+    return EmplaceMulti(hint.ptr_, std::forward<Args>(args)...);
   }
 
-  BTNode *FindNode(value_type value) const {
+  // Replaces the contents with [first, last) in O(n) when the range is
+  // already sorted; otherwise the range is sorted first. Keeps the first of
+  // equal values, like a series of insert() calls.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    AssignSorted(first, last, true);
+  }
+
+  // Same as assign_sorted, but keeps equal values in their input order.
+  template <class InputIt>
+  void assign_sorted_def(InputIt first, InputIt last) {
+    AssignSorted(first, last, false);
+  }
+
+  // The bulk operations also come with a Parallel policy. The nodes of a
+  // random access range, of a merge or of a set operation are then split
+  // by key among the threads; allocation is only spread too when the
+  // allocator is stateless, as a stateful one may not be thread-safe.
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last, Parallel policy) {
+    AssignSorted(first, last, true, policy.threads);
+  }
+
+  template <class InputIt>
+  void assign_sorted_def(InputIt first, InputIt last, Parallel policy) {
+    AssignSorted(first, last, false, policy.threads);
+  }
+
+  template <class Key>
+  BTNode *FindNode(const Key &key) const {
     BTNode *tmp = root;
     while (tmp && !tmp->is_fake) {
-      if (value < tmp->val) {
+      PrefetchBelow(tmp);
+      if (Less(key, KeyOf(tmp->val))) {
         tmp = tmp->left;
-      } else if (tmp->val < value) {
+      } else if (Less(KeyOf(tmp->val), key)) {
         tmp = tmp->right;
       } else
         return tmp;
@@ -337,6 +664,8 @@ class BinaryTree {
   }
 
   void swap(BinaryTree &other) {
+    std::swap(comp(), other.comp());
+    std::swap(node_alloc(), other.node_alloc());
     std::swap(root, other.root);
     std::swap(fake_node, other.fake_node);
     std::swap(bt_size, other.bt_size);
@@ -356,130 +685,334 @@ class BinaryTree {
     }
   }
 
-  void merge(BinaryTree &other) {
-    BinaryTree<K, Compare> mergedTree;
+  // Moves the nodes of other into this tree. Equal elements already here
+  // stay in other, as with std::set::merge. O(m log n) when other is much
+  // smaller, O(n + m) otherwise.
+  void merge(BinaryTree &other) { MergeNodes(other, true); }
 
-    for (const auto &value : *this) {
-      mergedTree.insert(value);
-    }
+  void merge_multiset(BinaryTree &other) { MergeNodes(other, false); }
 
-    for (const auto &value : other) {
-      mergedTree.insert(value);
-    }
+  void merge(BinaryTree &other, Parallel policy) {
+    MergeNodes(other, true, policy.threads);
+  }
 
-    *this = std::move(mergedTree);
-    other.clear();
+  void merge_multiset(BinaryTree &other, Parallel policy) {
+    MergeNodes(other, false, policy.threads);
   }
 
-  void merge_multiset(BinaryTree &other) {
-    BinaryTree<K, Compare> mergedTree;
+  // Moves the elements not less than key into the returned tree; those
+  // less than key stay. Nodes are relinked, not copied, in O(log n).
+  BinaryTree split(const key_type &key) {
+    BinaryTree high(key_comp(), get_allocator());
+    if (empty()) return high;
+    size_type size = bt_size;
+    auto [low_root, high_root] = SplitTree(DetachRoot(), key);
+    high.AdoptRoot(high_root, SizeOf(high_root));
+    AdoptRoot(low_root, size - SizeOf(high_root));
+    return high;
+  }
 
-    for (const auto &value : *this) {
-      mergedTree.insert_def(value);
-    }
+  // Moves every element of other into this tree in O(log n) when all of
+  // them go after, or all before, the elements here; throws
+  // std::invalid_argument if the key ranges overlap. Nodes are copied
+  // only if the allocators differ.
+  void join(BinaryTree &other) { JoinNodes(other, true); }
+
+  // Same for multisets, where the ranges may share their boundary key.
+  void join_multiset(BinaryTree &other) { JoinNodes(other, false); }
+
+  // Set algebra in the sense of the std:: algorithms of the same names,
+  // so that one function serves sets and multisets: a value held m times
+  // here and n times in other is held max(m, n) times by the union,
+  // min(m, n) by the intersection, m - n by the difference and |m - n| by
+  // the symmetric difference. The result uses this tree's allocator and is
+  // built balanced from the merged sequence, without per-element inserts.
+  BinaryTree set_union(const BinaryTree &other) const {
+    return Combine(other, kKeepLhs | kKeepRhs | kKeepCommon);
+  }
 
-    for (const auto &value : other) {
-      mergedTree.insert_def(value);
-    }
+  BinaryTree set_intersection(const BinaryTree &other) const {
+    return Combine(other, kKeepCommon);
+  }
+
+  BinaryTree set_difference(const BinaryTree &other) const {
+    return Combine(other, kKeepLhs);
+  }
+
+  BinaryTree set_symmetric_difference(const BinaryTree &other) const {
+    return Combine(other, kKeepLhs | kKeepRhs);
+  }
 
-    *this = std::move(mergedTree);
-    other.clear();
+  BinaryTree set_union(const BinaryTree &other, Parallel policy) const {
+    return Combine(other, kKeepLhs | kKeepRhs | kKeepCommon, policy.threads);
   }
 
-  iterator find(const value_type &value) {
-    BTNode *tmp = FindNode(value);
+  BinaryTree set_intersection(const BinaryTree &other,
+                              Parallel policy) const {
+    return Combine(other, kKeepCommon, policy.threads);
+  }
+
+  BinaryTree set_difference(const BinaryTree &other, Parallel policy) const {
+    return Combine(other, kKeepLhs, policy.threads);
+  }
+
+  BinaryTree set_symmetric_difference(const BinaryTree &other,
+                                      Parallel policy) const {
+    return Combine(other, kKeepLhs | kKeepRhs, policy.threads);
+  }
+
+  iterator find(const key_type &key) {
+    BTNode *tmp = FindNode(key);
     return iterator(tmp);
   }
 
-  const_iterator find(const value_type &value) const {
-    BTNode *tmp = FindNode(value);
+  const_iterator find(const key_type &key) const {
+    BTNode *tmp = FindNode(key);
     return const_iterator(tmp);
   }
 
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator find(const Key &key) {
+    return iterator(FindNode(key));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator find(const Key &key) const {
+    return const_iterator(FindNode(key));
+  }
+
   iterator lower_bound(const key_type &key) {
-    auto node = begin();
-    for (; node != end() && (*node < key); ++node) {
-    }
-    return node;
+    return iterator(LowerBoundNode(key));
   }
 
   const_iterator lower_bound(const key_type &key) const {
-    auto node = begin();
-    for (; node != end() && (*node < key); ++node) {
-    }
-    return node;
+    return const_iterator(LowerBoundNode(key));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator lower_bound(const Key &key) {
+    return iterator(LowerBoundNode(key));
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key &key) const {
+    return const_iterator(LowerBoundNode(key));
   }
 
   iterator upper_bound(const key_type &key) {
-    auto node = begin();
-    for (; node != end() && (*node <= key); ++node) {
-    }
-    return node;
+    return iterator(UpperBoundNode(key));
   }
 
   const_iterator upper_bound(const key_type &key) const {
-    auto node = begin();
-    for (; node != end() && (*node <= key); ++node) {
-    }
-    return node;
+    return const_iterator(UpperBoundNode(key));
   }
 
-  template <typename... Args>
-  std::pair<iterator, bool> emplace(Args &&...args) {
-    std::pair<iterator, bool> it;
-    for (auto &&item : {std::forward<Args>(args)...}) {
-      it = insert(item);
-    }
-    return it;
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  iterator upper_bound(const Key &key) {
+    return iterator(UpperBoundNode(key));
   }
 
-  size_type count(const key_type &key) const {
-    size_type n = 0;
-    for (auto it = find(key); it != end() && *it == key; ++it, ++n) {
-    }
-    return n;
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key &key) const {
+    return const_iterator(UpperBoundNode(key));
+  }
+
+  size_type count(const key_type &key) const { return CountNodes(key); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count(const Key &key) const {
+    return CountNodes(key);
+  }
+
+  template <class Fn>
+  void for_each(Fn fn) const {
+    for (const_reference value : *this) fn(value);
+  }
+
+  bool contains(const key_type &key) const {
+    return FindNode(key) != fake_node;
+  }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contains(const Key &key) const {
+    return FindNode(key) != fake_node;
+  }
+
+  // Order statistics, all O(log n) through the subtree sizes.
+  // nth(k) is the k-th smallest element (from 0), end() if k >= size().
+  iterator nth(size_type k) { return iterator(NthNode(k)); }
+  const_iterator nth(size_type k) const { return const_iterator(NthNode(k)); }
+
+  // Number of elements less than key, i.e. the index of lower_bound(key).
+  size_type rank(const key_type &key) const { return RankOf(key, false); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type rank(const Key &key) const {
+    return RankOf(key, false);
+  }
+
+  // Number of elements in [lo, hi).
+  size_type count_range(const key_type &lo, const key_type &hi) const {
+    return Less(lo, hi) ? RankOf(hi, false) - RankOf(lo, false) : 0;
   }
 
-  bool contains(const value_type &value) const {
-    return FindNode(value) != fake_node;
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  size_type count_range(const Key &lo, const Key &hi) const {
+    return Less(lo, hi) ? RankOf(hi, false) - RankOf(lo, false) : 0;
   }
 
+  key_compare key_comp() const { return comp(); }
+
+  allocator_type get_allocator() const { return Allocator(node_alloc()); }
+
   void erase(iterator pos) {
     if (pos == end()) throw std::out_of_range("List is empty");
-    BTNode *node = pos.ptr_;
-    if (node->left == nullptr && node->right == nullptr) {
-      RemoveLeafNode(node);
-    } else if (node->left == nullptr || node->right == nullptr) {
-      RemoveNodeWithOneChild(node);
-    } else {
-      RemoveNodeWithTwoChildren(node);
+    DeleteNode(UnlinkNode(pos.ptr_));
+  }
+
+  node_type extract(iterator pos) {
+    if (pos == end()) return node_type();
+    return node_type(UnlinkNode(pos.ptr_), node_alloc());
+  }
+
+  node_type extract(const key_type &key) { return extract(find(key)); }
+
+  insert_return_type insert(node_type &&handle) {
+    if (handle.empty()) return {end(), false, node_type()};
+    BTNode *parent = nullptr;
+    bool to_left = false;
+    if (!FindLeafSlot(KeyOf(handle.value()), true, parent, to_left)) {
+      return {iterator(parent), false, std::move(handle)};
     }
-    --bt_size;
+    BTNode *node = TakeNode(std::move(handle));
+    LinkNode(node, parent, to_left);
+    return {iterator(node), true, node_type()};
+  }
+
+  iterator insert_def(node_type &&handle) {
+    if (handle.empty()) return end();
+    BTNode *parent = nullptr;
+    bool to_left = false;
+    FindLeafSlot(KeyOf(handle.value()), false, parent, to_left);
+    BTNode *node = TakeNode(std::move(handle));
+    LinkNode(node, parent, to_left);
+    return iterator(node);
   }
 
  private:
+  using CompareBase = EmptyBaseHolder<Compare, 0>;
+  using NodeAllocator = TreeNodeAllocator<K, Allocator, Threaded>;
+  using AllocatorBase = EmptyBaseHolder<NodeAllocator, 1>;
+  using NodeTraits = std::allocator_traits<NodeAllocator>;
+
   BTNode *root = nullptr;
-  BTNode *fake_node = new BTNode();
+  BTNode *fake_node = NewNode();
   size_type bt_size = 0;
 
-  BTNode *CopyTree(const BTNode *btNode) {
-    if (btNode == nullptr) return nullptr;
-    auto *newNode = new BTNode(btNode->val);
-    newNode->parent = btNode->parent;  // !!!
-    if (btNode->left) newNode->left = CopyTree(btNode->left);
-    if (btNode->right && !btNode->right->is_fake) {
-      newNode->right = CopyTree(btNode->right);
-    } else if (btNode->right && btNode->right->is_fake)
-      InsertFakeNode(newNode);
-    return newNode;
+  const Compare &comp() const { return CompareBase::get(); }
+  Compare &comp() { return CompareBase::get(); }
+  const NodeAllocator &node_alloc() const { return AllocatorBase::get(); }
+  NodeAllocator &node_alloc() { return AllocatorBase::get(); }
+
+  template <class... Args>
+  BTNode *NewNode(Args &&...args) {
+    BTNode *node = NodeTraits::allocate(node_alloc(), 1);
+    try {
+      NodeTraits::construct(node_alloc(), node, std::in_place,
+                            std::forward<Args>(args)...);
+    } catch (...) {
+      NodeTraits::deallocate(node_alloc(), node, 1);
+      throw;
+    }
+    return node;
+  }
+
+  // Unlinks a node from the tree without freeing it and moves the fake
+  // node to the new maximum if needed.
+  BTNode *UnlinkNode(BTNode *node) {
+    BTNode *max = fake_node->parent;
+    if (node == max) {
+      max = node->left ? MaxNode(node->left) : node->parent;
+    }
+    fake_node->parent->right = nullptr;
+    RemoveFromTree(node);
+    if constexpr (Threaded) {
+      node->prev->next = node->next;
+      node->next->prev = node->prev;
+    }
+    if (--bt_size) {
+      max->right = fake_node;
+      fake_node->parent = max;
+    } else {
+      MakeRootFake();
+    }
+    return node;
+  }
+
+  // Takes the node out of a handle; a node from a different allocator is
+  // moved into one of ours.
+  BTNode *TakeNode(node_type &&handle) {
+    BTNode *node = handle.node_;
+    if (!(*handle.alloc_ == node_alloc())) {
+      node = NewNode(std::move(handle.node_->val));
+      handle.reset();
+    }
+    handle.node_ = nullptr;
+    handle.alloc_.reset();
+    return node;
+  }
+
+  void DeleteNode(BTNode *node) {
+    NodeTraits::destroy(node_alloc(), node);
+    NodeTraits::deallocate(node_alloc(), node, 1);
+  }
+
+  // Copies the tree under source in preorder, walking both trees by their
+  // parent links instead of recursing, and hangs our fake node on the copy.
+  BTNode *CopyTree(const BTNode *source) {
+    BTNode *copy = CopyNode(source, nullptr);
+    try {
+      const BTNode *from = source;
+      BTNode *to = copy;
+      while (to) {
+        if (from->left && !to->left) {
+          to->left = CopyNode(from->left, to);
+          from = from->left;
+          to = to->left;
+        } else if (from->right && !from->right->is_fake && !to->right) {
+          to->right = CopyNode(from->right, to);
+          from = from->right;
+          to = to->right;
+        } else {
+          from = from->parent;
+          to = to->parent;
+        }
+      }
+    } catch (...) {
+      RemoveNode(copy);
+      throw;
+    }
+    InsertFakeNode(copy);
+    return copy;
+  }
+
+  BTNode *CopyNode(const BTNode *source, BTNode *parent) {
+    BTNode *node = NewNode(source->val);
+    node->parent = parent;
+    node->is_red = source->is_red;
+    node->size = source->size;
+    return node;
   }
 
   void MakeRootFake() {
     fake_node->is_fake = true;
+    fake_node->is_red = false;
+    fake_node->size = 0;
 
     fake_node->parent = fake_node;
     fake_node->left = fake_node;
     fake_node->right = fake_node;
+    if constexpr (Threaded) fake_node->prev = fake_node->next = fake_node;
     root = fake_node;
   }
 
@@ -490,17 +1023,25 @@ class BinaryTree {
     fake_node->left = nullptr;  // added
   }
 
+  // Frees the subtree under btNode in postorder without recursion: each
+  // node is unhooked from its parent once its children are gone, and the
+  // walk climbs back up through the parent link.
   void RemoveNode(BTNode *btNode) {
-    if (btNode->left && !btNode->left->is_fake) {
-      RemoveNode(btNode->left);
-      btNode->left = nullptr;
-    }
-    if (btNode->right && !btNode->right->is_fake) {
-      RemoveNode(btNode->right);
-      btNode->right = nullptr;
+    BTNode *top = btNode->parent;
+    while (btNode != top) {
+      if (btNode->left) {
+        btNode = btNode->left;
+      } else if (btNode->right && !btNode->right->is_fake) {
+        btNode = btNode->right;
+      } else {
+        BTNode *parent = btNode->parent;
+        if (parent != top) {
+          (parent->left == btNode ? parent->left : parent->right) = nullptr;
+        }
+        DeleteNode(btNode);
+        btNode = parent;
+      }
     }
-    delete btNode;
-    btNode = nullptr;
   }
 
   BTNode *MinNode(BTNode *btNode) const {
@@ -517,79 +1058,1011 @@ class BinaryTree {
     return btNode;
   }
 
-  void RemoveLeafNode(BTNode *node) {
-    if (node->parent) {
-      if (node == node->parent->left) {
-        node->parent->left = nullptr;
+  template <class Key>
+  BTNode *LowerBoundNode(const Key &key) const {
+    BTNode *result = fake_node;
+    BTNode *tmp = root;
+    while (tmp && !tmp->is_fake) {
+      PrefetchBelow(tmp);
+      if (Less(KeyOf(tmp->val), key)) {
+        tmp = tmp->right;
+      } else {
+        result = tmp;
+        tmp = tmp->left;
+      }
+    }
+    return result;
+  }
+
+  BTNode *NthNode(size_type k) const {
+    if (k >= bt_size) return fake_node;
+    BTNode *tmp = root;
+    while (k != SizeOf(tmp->left)) {
+      if (k < SizeOf(tmp->left)) {
+        tmp = tmp->left;
       } else {
-        node->parent->right = nullptr;
+        k -= SizeOf(tmp->left) + 1;
+        tmp = tmp->right;
+      }
+    }
+    return tmp;
+  }
+
+  // Counts elements less than key, or not greater than key with
+  // or_equal set.
+  template <class Key>
+  size_type RankOf(const Key &key, bool or_equal) const {
+    size_type rank = 0;
+    BTNode *tmp = root;
+    while (tmp && !tmp->is_fake) {
+      if (or_equal ? !Less(key, KeyOf(tmp->val))
+                   : Less(KeyOf(tmp->val), key)) {
+        rank += SizeOf(tmp->left) + 1;
+        tmp = tmp->right;
+      } else {
+        tmp = tmp->left;
+      }
+    }
+    return rank;
+  }
+
+  template <class Key>
+  BTNode *UpperBoundNode(const Key &key) const {
+    BTNode *result = fake_node;
+    BTNode *tmp = root;
+    while (tmp && !tmp->is_fake) {
+      PrefetchBelow(tmp);
+      if (Less(key, KeyOf(tmp->val))) {
+        result = tmp;
+        tmp = tmp->left;
+      } else {
+        tmp = tmp->right;
+      }
+    }
+    return result;
+  }
+
+  // Merges the two sorted node sequences and relinks them into balanced
+  // trees, so no node is allocated when both trees share an allocator.
+  // With threads, both sequences are cut at the same keys, so that equal
+  // keys meet in one piece, and the pieces are merged side by side. If
+  // anything throws, both trees are rebuilt from their own nodes. A much
+  // smaller other is spliced in node by node instead.
+  void MergeNodes(BinaryTree &other, bool unique, unsigned threads = 1) {
+    if (&other == this || other.empty()) return;
+    if (MergeBySearch(size(), other.size())) {
+      SpliceNodes(other, unique);
+      return;
+    }
+    std::vector<BTNode *> mine = DetachNodes(threads);
+    std::vector<BTNode *> theirs;
+    std::vector<BTNode *> merged;
+    std::vector<BTNode *> rest;
+    try {
+      theirs = other.DetachNodes(threads);
+      size_type tasks = ParallelTasks(mine.size() + theirs.size(), threads);
+      auto less = [this](const BTNode *lhs, const BTNode *rhs) {
+        return Less(KeyOf(lhs->val), KeyOf(rhs->val));
+      };
+      const auto &larger = mine.size() < theirs.size() ? theirs : mine;
+      std::vector<size_type> mine_cuts{0};
+      std::vector<size_type> theirs_cuts{0};
+      for (size_type task = 1; task < tasks; ++task) {
+        BTNode *cut = larger[larger.size() * task / tasks];
+        mine_cuts.push_back(
+            std::lower_bound(mine.begin(), mine.end(), cut, less) -
+            mine.begin());
+        theirs_cuts.push_back(
+            std::lower_bound(theirs.begin(), theirs.end(), cut, less) -
+            theirs.begin());
+      }
+      mine_cuts.push_back(mine.size());
+      theirs_cuts.push_back(theirs.size());
+
+      std::vector<std::vector<BTNode *>> merged_pieces(tasks);
+      std::vector<std::vector<BTNode *>> rest_pieces(tasks);
+      ParallelFor(tasks, [&](size_t task) {
+        MergeRange(mine.begin() + mine_cuts[task],
+                   mine.begin() + mine_cuts[task + 1],
+                   theirs.begin() + theirs_cuts[task],
+                   theirs.begin() + theirs_cuts[task + 1], unique,
+                   merged_pieces[task], rest_pieces[task]);
+      });
+      merged = Concat(merged_pieces);
+      rest = Concat(rest_pieces);
+      if (!(node_alloc() == other.node_alloc())) {
+        AdoptMerged(other, theirs, rest, merged);
+      }
+    } catch (...) {
+      BuildFromNodes(mine);
+      other.BuildFromNodes(theirs);
+      throw;
+    }
+    BuildFromNodes(merged, threads);
+    other.BuildFromNodes(rest, threads);
+  }
+
+  // Moves the nodes of other over one at a time, each to the slot a search
+  // from the root finds. If the allocators differ, each is copied just
+  // before it leaves other, so a throw leaves every element in one of the
+  // trees.
+  void SpliceNodes(BinaryTree &other, bool unique) {
+    bool adopt = !(node_alloc() == other.node_alloc());
+    for (iterator it = other.begin(); it != other.end();) {
+      BTNode *node = (it++).ptr_;
+      BTNode *parent = nullptr;
+      bool to_left = false;
+      if (!FindLeafSlot(KeyOf(node->val), unique, parent, to_left)) continue;
+      BTNode *moved =
+          adopt ? NewNode(std::move_if_noexcept(node->val)) : node;
+      other.UnlinkNode(node);
+      if (adopt) other.DeleteNode(node);
+      LinkNode(moved, parent, to_left);
+    }
+  }
+
+  // Appends the merged nodes to merged and, for sets, the nodes of theirs
+  // whose keys are in mine to rest.
+  template <class NodeIt>
+  void MergeRange(NodeIt mine, NodeIt mine_end, NodeIt theirs,
+                  NodeIt theirs_end, bool unique,
+                  std::vector<BTNode *> &merged,
+                  std::vector<BTNode *> &rest) {
+    auto less = [this](const BTNode *lhs, const BTNode *rhs) {
+      return Less(KeyOf(lhs->val), KeyOf(rhs->val));
+    };
+    merged.reserve((mine_end - mine) + (theirs_end - theirs));
+    for (; theirs != theirs_end; ++theirs) {
+      BTNode *node = *theirs;
+      while (mine != mine_end &&
+             (unique ? less(*mine, node) : !less(node, *mine))) {
+        merged.push_back(*mine++);
+      }
+      if (unique && mine != mine_end && !less(node, *mine)) {
+        rest.push_back(node);
+      } else {
+        merged.push_back(node);
+      }
+    }
+    merged.insert(merged.end(), mine, mine_end);
+  }
+
+  // Replaces the nodes of theirs that went to merged, that is all but
+  // rest, with nodes of our allocator and frees them. Nothing changes
+  // unless all the new nodes could be made.
+  void AdoptMerged(BinaryTree &other, const std::vector<BTNode *> &theirs,
+                   const std::vector<BTNode *> &rest,
+                   std::vector<BTNode *> &merged) {
+    std::vector<BTNode *> moving;
+    moving.reserve(theirs.size() - rest.size());
+    auto kept = rest.begin();
+    for (BTNode *node : theirs) {
+      if (kept != rest.end() && *kept == node) {
+        ++kept;
+      } else {
+        moving.push_back(node);
+      }
+    }
+    std::vector<BTNode *> adopted = AdoptNodes(moving);
+    auto from = moving.begin();
+    for (BTNode *&node : merged) {
+      if (from != moving.end() && node == *from) {
+        node = adopted[from - moving.begin()];
+        ++from;
       }
+    }
+    for (BTNode *node : moving) other.DeleteNode(node);
+  }
+
+  void JoinNodes(BinaryTree &other, bool unique) {
+    if (&other == this || other.empty()) return;
+    auto precedes = [this, unique](const BTNode *lhs, const BTNode *rhs) {
+      return unique ? Less(KeyOf(lhs->val), KeyOf(rhs->val))
+                    : !Less(KeyOf(rhs->val), KeyOf(lhs->val));
+    };
+    bool after = empty() || precedes(fake_node->parent,
+                                     MinNode(other.root));
+    if (!after && !precedes(other.fake_node->parent, MinNode(root))) {
+      throw std::invalid_argument("Key ranges overlap");
+    }
+    size_type size = bt_size + other.bt_size;
+    BTNode *theirs = TakeTree(other);
+    BTNode *mine = DetachRoot();
+    BTNode *low = after ? mine : theirs;
+    BTNode *high = after ? theirs : mine;
+    if constexpr (Threaded) {
+      if (low && high) {
+        BTNode *last = MaxNode(low);
+        BTNode *first = MinNode(high);
+        last->next = first;
+        first->prev = last;
+      }
+    }
+    AdoptRoot(ConcatTrees(low, high), size);
+  }
+
+  // Empties other and returns its nodes as a detached tree owned by our
+  // allocator, copying them only if the allocators differ.
+  BTNode *TakeTree(BinaryTree &other) {
+    if (node_alloc() == other.node_alloc()) return other.DetachRoot();
+    BinaryTree adopted(key_comp(), get_allocator());
+    std::vector<BTNode *> nodes = other.DetachNodes();
+    try {
+      adopted.BuildFromNodes(AdoptNodes(nodes));
+    } catch (...) {
+      other.BuildFromNodes(nodes);
+      throw;
+    }
+    for (BTNode *node : nodes) other.DeleteNode(node);
+    return adopted.DetachRoot();
+  }
+
+  // Empties the tree and returns its nodes as a detached tree: no fake
+  // node below the maximum and no parent above the root. A threaded tree
+  // keeps its order links, except at the two ends.
+  BTNode *DetachRoot() {
+    if (empty()) return nullptr;
+    BTNode *top = root;
+    fake_node->parent->right = nullptr;
+    MakeRootFake();
+    bt_size = 0;
+    return top;
+  }
+
+  // Makes a detached tree of size nodes the contents of this empty tree.
+  // The joins on the way may have left root pointing anywhere.
+  void AdoptRoot(BTNode *top, size_type size) {
+    if (top == nullptr) {
+      MakeRootFake();
+      return;
+    }
+    root = top;
+    root->parent = nullptr;
+    root->is_red = false;
+    bt_size = size;
+    InsertFakeNode(root);
+    if constexpr (Threaded) {
+      BTNode *first = MinNode(root);
+      BTNode *last = fake_node->parent;
+      first->prev = fake_node;
+      fake_node->next = first;
+      last->next = fake_node;
+      fake_node->prev = last;
+    }
+  }
+
+  static size_type BlackHeight(const BTNode *btNode) {
+    size_type height = 0;
+    for (; btNode; btNode = btNode->left) height += !btNode->is_red;
+    return height;
+  }
+
+  // Joins two detached trees and the node between them into one. The
+  // shorter tree hangs in place of a black node of its black height on
+  // the near spine of the taller one, under a red middle, and the usual
+  // insert fix-up repairs red-red links above. Costs O(1 + difference
+  // of black heights).
+  BTNode *JoinTrees(BTNode *low, BTNode *middle, BTNode *high) {
+    for (BTNode *top : {low, high}) {
+      if (top) {
+        top->parent = nullptr;
+        top->is_red = false;
+      }
+    }
+    size_type low_height = BlackHeight(low);
+    size_type high_height = BlackHeight(high);
+    if (low_height == high_height) {
+      middle->is_red = false;
+      HangChildren(middle, low, high);
+      middle->parent = nullptr;
+      return middle;
+    }
+    bool low_taller = low_height > high_height;
+    size_type height = std::max(low_height, high_height);
+    size_type target = std::min(low_height, high_height);
+    root = low_taller ? low : high;
+    BTNode *parent = nullptr;
+    BTNode *spine = root;
+    while (spine && (spine->is_red || height > target)) {
+      height -= !spine->is_red;
+      parent = spine;
+      spine = low_taller ? spine->right : spine->left;
+    }
+    middle->is_red = true;
+    if (low_taller) {
+      HangChildren(middle, spine, high);
+      parent->right = middle;
     } else {
-      root = nullptr;
+      HangChildren(middle, low, spine);
+      parent->left = middle;
+    }
+    middle->parent = parent;
+    for (BTNode *up = parent; up; up = up->parent) UpdateSize(up);
+    RebalanceAfterInsert(middle);
+    return root;
+  }
+
+  static void HangChildren(BTNode *node, BTNode *left, BTNode *right) {
+    node->left = left;
+    node->right = right;
+    if (left) left->parent = node;
+    if (right) right->parent = node;
+    UpdateSize(node);
+  }
+
+  // Joins two detached trees, every key of low going first, through the
+  // least node of high.
+  BTNode *ConcatTrees(BTNode *low, BTNode *high) {
+    if (low == nullptr || high == nullptr) return low ? low : high;
+    root = high;
+    BTNode *middle = MinNode(high);
+    RemoveFromTree(middle);
+    return JoinTrees(low, middle, root);
+  }
+
+  // Splits a detached tree into the nodes less than key and the rest by
+  // joining the subtrees hanging off the search path. The black heights
+  // of successive joins telescope, so the whole split costs O(log n).
+  std::pair<BTNode *, BTNode *> SplitTree(BTNode *node,
+                                          const key_type &key) {
+    if (node == nullptr) return {nullptr, nullptr};
+    BTNode *left = node->left;
+    BTNode *right = node->right;
+    if (Less(KeyOf(node->val), key)) {
+      auto [low, high] = SplitTree(right, key);
+      return {JoinTrees(left, node, low), high};
+    }
+    auto [low, high] = SplitTree(left, key);
+    return {low, JoinTrees(high, node, right)};
+  }
+
+  // Which elements Combine keeps: those only in this tree, those only in
+  // the other one and those in both.
+  enum : unsigned { kKeepLhs = 1, kKeepRhs = 2, kKeepCommon = 4 };
+
+  // Ordered steps a merge takes over elements it drops before it looks the
+  // next key up from the root instead.
+  static constexpr int kGallopSteps = 8;
+
+  // Merges the two sequences in order. Runs of elements that are dropped
+  // are skipped by SkipLess, so when one operand is much smaller, an
+  // intersection or difference costs O(log n) per element of the smaller
+  // one rather than a walk over the larger one. With threads, both trees
+  // are cut at the same keys, taken from the larger one by rank, and the
+  // pieces are merged side by side.
+  BinaryTree Combine(const BinaryTree &other, unsigned keep,
+                     unsigned threads = 1) const {
+    BinaryTree result(key_comp(), get_allocator());
+    const BinaryTree &larger = size() < other.size() ? other : *this;
+    size_type tasks =
+        ParallelTasks(size() + other.size(), AllocThreads(threads));
+    std::vector<const_iterator> lhs_cuts{begin()};
+    std::vector<const_iterator> rhs_cuts{other.begin()};
+    for (size_type task = 1; task < tasks; ++task) {
+      const value_type &cut =
+          larger.NthNode(larger.size() * task / tasks)->val;
+      lhs_cuts.emplace_back(LowerBoundNode(KeyOf(cut)));
+      rhs_cuts.emplace_back(other.LowerBoundNode(KeyOf(cut)));
+    }
+    lhs_cuts.push_back(end());
+    rhs_cuts.push_back(other.end());
+
+    std::vector<std::vector<BTNode *>> pieces(tasks);
+    try {
+      ParallelFor(tasks, [&](size_t task) {
+        CombineRange(lhs_cuts[task], lhs_cuts[task + 1], other,
+                     rhs_cuts[task], rhs_cuts[task + 1], keep, result,
+                     pieces[task]);
+      });
+    } catch (...) {
+      for (auto &piece : pieces) {
+        for (BTNode *node : piece) result.DeleteNode(node);
+      }
+      throw;
+    }
+    result.BuildFromNodes(Concat(pieces), threads);
+    return result;
+  }
+
+  void CombineRange(const_iterator lhs, const_iterator lhs_end,
+                    const BinaryTree &other, const_iterator rhs,
+                    const_iterator rhs_end, unsigned keep,
+                    BinaryTree &result, std::vector<BTNode *> &nodes) const {
+    while (lhs != lhs_end && rhs != rhs_end) {
+      if (Less(KeyOf(*lhs), KeyOf(*rhs))) {
+        if (keep & kKeepLhs) {
+          nodes.push_back(result.NewNode(*lhs++));
+        } else {
+          lhs = SkipLess(lhs, KeyOf(*rhs));
+        }
+      } else if (Less(KeyOf(*rhs), KeyOf(*lhs))) {
+        if (keep & kKeepRhs) {
+          nodes.push_back(result.NewNode(*rhs++));
+        } else {
+          rhs = other.SkipLess(rhs, KeyOf(*lhs));
+        }
+      } else {
+        if (keep & kKeepCommon) nodes.push_back(result.NewNode(*lhs));
+        ++lhs;
+        ++rhs;
+      }
+    }
+    for (; (keep & kKeepLhs) && lhs != lhs_end; ++lhs) {
+      nodes.push_back(result.NewNode(*lhs));
+    }
+    for (; (keep & kKeepRhs) && rhs != rhs_end; ++rhs) {
+      nodes.push_back(result.NewNode(*rhs));
+    }
+  }
+
+  static std::vector<BTNode *> Concat(
+      std::vector<std::vector<BTNode *>> &pieces) {
+    if (pieces.size() == 1) return std::move(pieces.front());
+    std::vector<BTNode *> nodes;
+    size_type count = 0;
+    for (auto &piece : pieces) count += piece.size();
+    nodes.reserve(count);
+    for (auto &piece : pieces) {
+      nodes.insert(nodes.end(), piece.begin(), piece.end());
+    }
+    return nodes;
+  }
+
+  // Threads that may allocate nodes at once: only a stateless allocator
+  // is taken to be thread-safe.
+  static unsigned AllocThreads(unsigned threads) {
+    return NodeTraits::is_always_equal::value ? threads : 1;
+  }
+
+  // Moves pos to the first element not less than key: a few steps in
+  // order, then one descent from the root.
+  const_iterator SkipLess(const_iterator pos, const key_type &key) const {
+    for (int step = 0; step < kGallopSteps; ++step, ++pos) {
+      if (pos == end() || !Less(KeyOf(*pos), key)) return pos;
+    }
+    return const_iterator(LowerBoundNode(key));
+  }
+
+  // Makes a node of our allocator for each of nodes, which belong to
+  // another allocator. All or nothing: every node is allocated before any
+  // value is taken, and values are moved only where that cannot throw, so
+  // after a throw nodes hold their values as before. The caller frees
+  // nodes once it keeps the result.
+  std::vector<BTNode *> AdoptNodes(const std::vector<BTNode *> &nodes) {
+    std::vector<BTNode *> adopted(nodes.size(), nullptr);
+    size_type made = 0;
+    try {
+      for (BTNode *&node : adopted) {
+        node = NodeTraits::allocate(node_alloc(), 1);
+      }
+      for (; made < nodes.size(); ++made) {
+        NodeTraits::construct(node_alloc(), adopted[made], std::in_place,
+                              std::move_if_noexcept(nodes[made]->val));
+      }
+    } catch (...) {
+      for (size_type i = 0; i < made; ++i) {
+        NodeTraits::destroy(node_alloc(), adopted[i]);
+      }
+      for (BTNode *node : adopted) {
+        if (node) NodeTraits::deallocate(node_alloc(), node, 1);
+      }
+      throw;
     }
-    delete node;
+    return adopted;
   }
 
-  void RemoveNodeWithOneChild(BTNode *node) {
-    BTNode *child = (node->left != nullptr) ? node->left : node->right;
+  // Empties the tree and returns its nodes in order, still allocated.
+  // With threads, each one walks a piece that starts at an nth node.
+  std::vector<BTNode *> DetachNodes(unsigned threads = 1) {
+    std::vector<BTNode *> nodes(bt_size);
+    size_type tasks = ParallelTasks(bt_size, threads);
+    ParallelFor(tasks, [this, &nodes, tasks](size_t task) {
+      size_type to = bt_size * (task + 1) / tasks;
+      iterator it(NthNode(bt_size * task / tasks));
+      for (size_type i = bt_size * task / tasks; i < to; ++i, ++it) {
+        nodes[i] = it.get();
+      }
+    });
+    MakeRootFake();
+    bt_size = 0;
+    return nodes;
+  }
 
-    if (node->parent) {
-      if (node == node->parent->left) {
-        node->parent->left = child;
+  template <class InputIt>
+  void AssignSorted(InputIt first, InputIt last, bool unique,
+                    unsigned threads = 1) {
+    clear();
+    std::vector<BTNode *> nodes = NewNodes(first, last, threads);
+
+    auto less = [this](const BTNode *lhs, const BTNode *rhs) {
+      return Less(KeyOf(lhs->val), KeyOf(rhs->val));
+    };
+    if (!std::is_sorted(nodes.begin(), nodes.end(), less)) {
+      std::stable_sort(nodes.begin(), nodes.end(), less);
+    }
+    if (unique && !nodes.empty()) {
+      auto kept = nodes.begin();
+      for (auto it = nodes.begin() + 1; it != nodes.end(); ++it) {
+        if (less(*kept, *it)) {
+          *++kept = *it;
+        } else {
+          DeleteNode(*it);
+        }
+      }
+      nodes.erase(kept + 1, nodes.end());
+    }
+    BuildFromNodes(nodes, threads);
+  }
+
+  // Allocates a node for each value of [first, last). The threads fill
+  // pieces of a random access range at once.
+  template <class InputIt>
+  std::vector<BTNode *> NewNodes(InputIt first, InputIt last,
+                                 unsigned threads) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    std::vector<BTNode *> nodes;
+    try {
+      if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                      Category>) {
+        size_type count = std::distance(first, last);
+        size_type tasks = ParallelTasks(count, AllocThreads(threads));
+        nodes.resize(count, nullptr);
+        ParallelFor(tasks, [this, first, count, tasks, &nodes](size_t task) {
+          size_type to = count * (task + 1) / tasks;
+          for (size_type i = count * task / tasks; i < to; ++i) {
+            nodes[i] = NewNode(first[i]);
+          }
+        });
       } else {
-        node->parent->right = child;
+        for (; first != last; ++first) nodes.push_back(NewNode(*first));
+      }
+    } catch (...) {
+      for (BTNode *node : nodes) {
+        if (node) DeleteNode(node);
       }
-      child->parent = node->parent;
+      throw;
+    }
+    return nodes;
+  }
+
+  // Links sorted nodes into a perfectly balanced tree; the tree must be
+  // empty. Only the deepest level is red, so every path has the same
+  // number of black nodes. Subtrees are disjoint, so threads can link
+  // them at once.
+  void BuildFromNodes(const std::vector<BTNode *> &nodes,
+                      unsigned threads = 1) {
+    if (nodes.empty()) return;
+    size_type count = nodes.size();
+    size_type tasks = ParallelTasks(count, threads);
+    size_type red_depth = 0;
+    for (size_type n = count; n > 1; n /= 2) ++red_depth;
+    root = LinkBalanced(nodes, 0, count, nullptr, 0, red_depth, tasks);
+    bt_size = count;
+    InsertFakeNode(nodes.back());
+    if constexpr (Threaded) {
+      ParallelFor(tasks, [this, &nodes, count, tasks](size_t task) {
+        size_type to = count * (task + 1) / tasks;
+        for (size_type i = count * task / tasks; i < to; ++i) {
+          nodes[i]->prev = i == 0 ? fake_node : nodes[i - 1];
+          nodes[i]->next = i + 1 == count ? fake_node : nodes[i + 1];
+        }
+      });
+      fake_node->next = nodes.front();
+      fake_node->prev = nodes.back();
+    }
+  }
+
+  // Rebuilds the order links of a threaded tree from its shape, walking it
+  // through the parent links. The list is closed through the fake node.
+  void ThreadAll() {
+    if constexpr (Threaded) {
+      BTNode *prev = fake_node;
+      BTNode *node = MinNode(root);
+      while (!node->is_fake) {
+        prev->next = node;
+        node->prev = prev;
+        prev = node;
+        if (node->right) {
+          node = MinNode(node->right);
+        } else {
+          while (node == node->parent->right) node = node->parent;
+          node = node->parent;
+        }
+      }
+      prev->next = fake_node;
+      fake_node->prev = prev;
+    }
+  }
+
+  // Links nodes[from, to) under parent; with tasks above one, the left
+  // subtree goes to another thread.
+  BTNode *LinkBalanced(const std::vector<BTNode *> &nodes, size_type from,
+                       size_type to, BTNode *parent, size_type depth,
+                       size_type red_depth, size_type tasks = 1) {
+    if (from == to) return nullptr;
+    size_type middle = from + (to - from) / 2;
+    BTNode *node = nodes[middle];
+    node->parent = parent;
+    node->is_red = depth == red_depth && depth != 0;
+    if (tasks > 1) {
+      ParallelFor(2, [&](size_t half) {
+        if (half == 0) {
+          node->left = LinkBalanced(nodes, from, middle, node, depth + 1,
+                                    red_depth, tasks / 2);
+        } else {
+          node->right = LinkBalanced(nodes, middle + 1, to, node, depth + 1,
+                                     red_depth, tasks - tasks / 2);
+        }
+      });
     } else {
-      root = child;
-      root->parent = nullptr;
+      node->left =
+          LinkBalanced(nodes, from, middle, node, depth + 1, red_depth);
+      node->right =
+          LinkBalanced(nodes, middle + 1, to, node, depth + 1, red_depth);
     }
-    delete node;
+    UpdateSize(node);
+    return node;
+  }
+
+  static bool IsRed(const BTNode *btNode) { return btNode && btNode->is_red; }
+
+  static void PrefetchNode(const BTNode *btNode) {
+#if defined(__GNUC__)
+    __builtin_prefetch(btNode);
+#endif
+    (void)btNode;
   }
 
-  void RemoveNodeWithTwoChildren(BTNode *node) {
-    BTNode *temp = MinNode(node->right);
+  // Prefetching never faults, so null and fake links need no checks.
+  static void PrefetchBelow(const BTNode *btNode) {
+    if constexpr (Prefetch::kEnabled) {
+      PrefetchNode(btNode->left);
+      PrefetchNode(btNode->right);
+    }
+  }
 
-    if (temp->right != nullptr) {
-      temp->right->parent = temp->parent;
+  // The next step forward reads the right child or the parent, or just
+  // the thread.
+  static void PrefetchStep(const BTNode *btNode, bool forward) {
+    if constexpr (Prefetch::kEnabled) {
+      if constexpr (Threaded) {
+        PrefetchNode(forward ? btNode->next : btNode->prev);
+      } else {
+        PrefetchNode(forward ? btNode->right : btNode->left);
+        PrefetchNode(btNode->parent);
+      }
     }
+  }
+
+  static size_type SizeOf(const BTNode *btNode) {
+    return btNode ? btNode->size : 0;
+  }
+
+  static void UpdateSize(BTNode *btNode) {
+    btNode->size = SizeOf(btNode->left) + SizeOf(btNode->right) + 1;
+  }
+
+  static const key_type &KeyOf(const value_type &value) {
+    return KeyOfValue<K, Compare>::Get(value);
+  }
+
+  template <class Lhs, class Rhs>
+  bool Less(const Lhs &lhs, const Rhs &rhs) const {
+    return comp()(lhs, rhs);
+  }
+
+  template <class Key>
+  size_type CountNodes(const Key &key) const {
+    return RankOf(key, true) - RankOf(key, false);
+  }
 
-    if (temp->parent->left == temp) {
-      temp->parent->left = temp->right;
+  template <class... Args>
+  std::pair<iterator, bool> EmplaceUnique(const BTNode *hint, Args &&...args) {
+    using ArgsKey = EmplaceKey<key_type, value_type, std::decay_t<Args>...>;
+    if constexpr (ArgsKey::value) {
+      return TryEmplace(hint, ArgsKey::Get(args...),
+                        std::forward<Args>(args)...);
     } else {
-      temp->parent->right = temp->right;
+      BTNode *node = NewNode(std::forward<Args>(args)...);
+      BTNode *parent = nullptr;
+      bool to_left = false;
+      if (!FindSlot(hint, KeyOf(node->val), true, parent, to_left)) {
+        DeleteNode(node);
+        return std::make_pair(iterator(parent), false);
+      }
+      LinkNode(node, parent, to_left);
+      return std::make_pair(iterator(node), true);
+    }
+  }
+
+  template <class... Args>
+  std::pair<iterator, bool> TryEmplace(const BTNode *hint,
+                                       const key_type &key, Args &&...args) {
+    BTNode *parent = nullptr;
+    bool to_left = false;
+    if (!FindSlot(hint, key, true, parent, to_left)) {
+      return std::make_pair(iterator(parent), false);
+    }
+    BTNode *node = NewNode(std::forward<Args>(args)...);
+    LinkNode(node, parent, to_left);
+    return std::make_pair(iterator(node), true);
+  }
+
+  template <class... Args>
+  iterator EmplaceMulti(const BTNode *hint, Args &&...args) {
+    BTNode *node = NewNode(std::forward<Args>(args)...);
+    BTNode *parent = nullptr;
+    bool to_left = false;
+    FindSlot(hint, KeyOf(node->val), false, parent, to_left);
+    LinkNode(node, parent, to_left);
+    return iterator(node);
+  }
+
+  // Like FindLeafSlot, but first tries the slot right before hint, which
+  // takes O(1) for end() and amortized O(1) for other hints. Only the
+  // search is saved: LinkNode updates the sizes up to the root.
+  bool FindSlot(const BTNode *hint, const key_type &key, bool unique,
+                BTNode *&parent, bool &to_left) {
+    if (hint && bt_size) {
+      BTNode *next = const_cast<BTNode *>(hint);
+      BTNode *prev = next->is_fake ? next->parent : PrevNode(next);
+      bool after_prev = prev == nullptr ||
+                        (unique ? Less(KeyOf(prev->val), key)
+                                : !Less(key, KeyOf(prev->val)));
+      bool before_next = next->is_fake ||
+                         (unique ? Less(key, KeyOf(next->val))
+                                 : !Less(KeyOf(next->val), key));
+      if (after_prev && before_next) {
+        to_left = !next->is_fake && next->left == nullptr;
+        parent = to_left ? next : prev;
+        return true;
+      }
     }
+    return FindLeafSlot(key, unique, parent, to_left);
+  }
 
-    temp->parent = node->parent;
-    if (node->parent != nullptr) {
-      if (node->parent->left == node) {
-        node->parent->left = temp;
+  // In-order predecessor of a real node, nullptr for the minimum.
+  BTNode *PrevNode(BTNode *node) {
+    if constexpr (Threaded) {
+      return node->prev->is_fake ? nullptr : node->prev;
+    }
+    if (node->left) return MaxNode(node->left);
+    BTNode *parent = node->parent;
+    while (parent && node == parent->left) {
+      node = parent;
+      parent = parent->parent;
+    }
+    return parent;
+  }
+
+  // Finds the parent a node with this key would hang under. Returns false
+  // with parent set to the equal node if unique is set and one exists.
+  bool FindLeafSlot(const key_type &key, bool unique, BTNode *&parent,
+                    bool &to_left) const {
+    BTNode *tmp = root->is_fake ? nullptr : root;
+    while (tmp) {
+      PrefetchBelow(tmp);
+      parent = tmp;
+      to_left = Less(key, KeyOf(tmp->val));
+      if (to_left) {
+        tmp = tmp->left;
+      } else if (unique && !Less(KeyOf(tmp->val), key)) {
+        return false;
       } else {
-        node->parent->right = temp;
+        tmp = tmp->right && !tmp->right->is_fake ? tmp->right : nullptr;
       }
     }
-    temp->left = node->left;
-    temp->right = node->right;
-    node->left->parent = temp;
-    if (node->right != nullptr) {
-      node->right->parent = temp;
+    return true;
+  }
+
+  // Hangs a detached node under parent and restores the red-black
+  // invariants. Counting the node in the sizes of all its ancestors makes
+  // this O(log n) even where the rebalancing stops early.
+  void LinkNode(BTNode *node, BTNode *parent, bool to_left) {
+    node->left = node->right = nullptr;
+    node->parent = parent;
+    node->is_red = true;
+    node->size = 1;
+    for (BTNode *up = parent; up; up = up->parent) ++up->size;
+    if (parent == nullptr) {
+      root = node;
+      InsertFakeNode(root);
+    } else if (to_left) {
+      parent->left = node;
+    } else {
+      if (parent->right) InsertFakeNode(node);
+      parent->right = node;
+    }
+    if constexpr (Threaded) {
+      BTNode *next = parent == nullptr ? fake_node
+                     : to_left         ? parent
+                                       : parent->next;
+      node->prev = next->prev;
+      node->next = next;
+      node->prev->next = node;
+      next->prev = node;
     }
+    ++bt_size;
+    RebalanceAfterInsert(node);
+  }
+
+  void RotateLeft(BTNode *node) {
+    BTNode *pivot = node->right;
+    node->right = pivot->left;
+    if (pivot->left) pivot->left->parent = node;
+    ReplaceChild(node, pivot);
+    pivot->left = node;
+    node->parent = pivot;
+    pivot->size = node->size;
+    UpdateSize(node);
+  }
 
-    if (node == root) {
-      root = temp;
+  void RotateRight(BTNode *node) {
+    BTNode *pivot = node->left;
+    node->left = pivot->right;
+    if (pivot->right) pivot->right->parent = node;
+    ReplaceChild(node, pivot);
+    pivot->right = node;
+    node->parent = pivot;
+    pivot->size = node->size;
+    UpdateSize(node);
+  }
+
+  // Puts replacement where node hangs under its parent.
+  void ReplaceChild(BTNode *node, BTNode *replacement) {
+    if (node->parent == nullptr) {
+      root = replacement;
+    } else if (node == node->parent->left) {
+      node->parent->left = replacement;
+    } else {
+      node->parent->right = replacement;
     }
+    if (replacement) replacement->parent = node->parent;
+  }
+
+  void RebalanceAfterInsert(BTNode *node) {
+    while (node != root && node->parent->is_red) {
+      BTNode *parent = node->parent;
+      BTNode *grand = parent->parent;
+      if (parent == grand->left) {
+        BTNode *uncle = grand->right;
+        if (IsRed(uncle)) {
+          parent->is_red = uncle->is_red = false;
+          grand->is_red = true;
+          node = grand;
+        } else {
+          if (node == parent->right) {
+            node = parent;
+            RotateLeft(node);
+            parent = node->parent;
+          }
+          parent->is_red = false;
+          grand->is_red = true;
+          RotateRight(grand);
+        }
+      } else {
+        BTNode *uncle = grand->left;
+        if (IsRed(uncle)) {
+          parent->is_red = uncle->is_red = false;
+          grand->is_red = true;
+          node = grand;
+        } else {
+          if (node == parent->left) {
+            node = parent;
+            RotateRight(node);
+            parent = node->parent;
+          }
+          parent->is_red = false;
+          grand->is_red = true;
+          RotateLeft(grand);
+        }
+      }
+    }
+    root->is_red = false;
+  }
+
+  // Unlinks node from a tree whose fake node is detached. Other nodes keep
+  // their identity, so iterators to them stay valid.
+  void RemoveFromTree(BTNode *node) {
+    BTNode *child = nullptr;
+    BTNode *child_parent = nullptr;
+    bool removed_red = node->is_red;
+    if (node->left == nullptr || node->right == nullptr) {
+      ShrinkPath(node->parent);
+      child = node->left ? node->left : node->right;
+      child_parent = node->parent;
+      ReplaceChild(node, child);
+    } else {
+      BTNode *next = MinNode(node->right);
+      ShrinkPath(next->parent);
+      removed_red = next->is_red;
+      child = next->right;
+      if (next->parent == node) {
+        child_parent = next;
+      } else {
+        child_parent = next->parent;
+        ReplaceChild(next, next->right);
+        next->right = node->right;
+        next->right->parent = next;
+      }
+      ReplaceChild(node, next);
+      next->left = node->left;
+      next->left->parent = next;
+      next->is_red = node->is_red;
+      next->size = node->size;
+    }
+    if (!removed_red) RebalanceAfterErase(child, child_parent);
+  }
 
-    delete node;
+  // One node is about to leave the subtrees of from and its ancestors.
+  static void ShrinkPath(BTNode *from) {
+    for (; from; from = from->parent) --from->size;
   }
 
-  void FreeNode(BTNode *node) {
-    if (node == nullptr) return;
-    FreeNode(node->left);
-    FreeNode(node->right);
-    delete node;
+  void RebalanceAfterErase(BTNode *node, BTNode *parent) {
+    while (node != root && !IsRed(node)) {
+      if (node == parent->left) {
+        BTNode *sibling = parent->right;
+        if (IsRed(sibling)) {
+          sibling->is_red = false;
+          parent->is_red = true;
+          RotateLeft(parent);
+          sibling = parent->right;
+        }
+        if (!IsRed(sibling->left) && !IsRed(sibling->right)) {
+          sibling->is_red = true;
+          node = parent;
+          parent = node->parent;
+        } else {
+          if (!IsRed(sibling->right)) {
+            sibling->left->is_red = false;
+            sibling->is_red = true;
+            RotateRight(sibling);
+            sibling = parent->right;
+          }
+          sibling->is_red = parent->is_red;
+          parent->is_red = false;
+          sibling->right->is_red = false;
+          RotateLeft(parent);
+          node = root;
+        }
+      } else {
+        BTNode *sibling = parent->left;
+        if (IsRed(sibling)) {
+          sibling->is_red = false;
+          parent->is_red = true;
+          RotateRight(parent);
+          sibling = parent->left;
+        }
+        if (!IsRed(sibling->left) && !IsRed(sibling->right)) {
+          sibling->is_red = true;
+          node = parent;
+          parent = node->parent;
+        } else {
+          if (!IsRed(sibling->left)) {
+            sibling->right->is_red = false;
+            sibling->is_red = true;
+            RotateLeft(sibling);
+            sibling = parent->left;
+          }
+          sibling->is_red = parent->is_red;
+          parent->is_red = false;
+          sibling->left->is_red = false;
+          RotateRight(parent);
+          node = root;
+        }
+      }
+    }
+    if (node) node->is_red = false;
   }
 };
 
+// Tree with O(1) iterator steps, for Set and Multiset:
+// Set<int, std::less<int>, std::allocator<int>, ThreadedTree<int>>.
+template <class K, class Compare = std::less<K>,
+          class Allocator = std::allocator<K>>
+using ThreadedTree = BinaryTree<K, Compare, Allocator, true>;
+
 }  // namespace s21
 
 #endif  // CPP2_S21_CONTAINERS_1_SRC_S21_TREE_H_
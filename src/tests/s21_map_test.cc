@@ -38,7 +38,7 @@ TEST(MapTest3, MoveConstructor) {
   for (auto it = c_copy.begin(); it != c_copy.end();) {
     if (it->first % 2 != 0 && (*i).first % 2 != 0) {
       it = c_copy.erase(it);
-      test_c_copy.erase(i);
+      test_c_copy.erase(i++);
     } else {
       ++it;
       ++i;
@@ -2,7 +2,12 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "../s21_concurrent.h"
 #include "../s21_map/s21_map.h"
 
 class MapTest : public ::testing::Test {
@@ -364,3 +369,321 @@ TEST_F(MapTest, testConstContains) {
   EXPECT_FALSE(s21_const.contains(""));
   EXPECT_FALSE(s21_const.contains("test"));
 }
+
+TEST_F(MapTest, testInsertExistingKey) {
+  auto s21_res = s21_test.insert({3, "other"});
+  auto std_res = std_test.insert({3, "other"});
+  EXPECT_EQ(s21_res.second, std_res.second);
+  EXPECT_EQ(s21_test.size(), std_test.size());
+  EXPECT_EQ(s21_test.at(3), std_test.at(3));
+}
+
+TEST_F(MapTest, testLookupLarge) {
+  for (int i = 0; i < 100000; ++i) {
+    s21_empty.insert(i, i * 2);
+  }
+  for (int i = 0; i < 100000; i += 7) {
+    EXPECT_EQ(s21_empty.at(i), i * 2);
+    EXPECT_TRUE(s21_empty.contains(i));
+    s21_empty[i] = i;
+  }
+  EXPECT_FALSE(s21_empty.contains(100000));
+  EXPECT_EQ(s21_empty[700], 700);
+  EXPECT_EQ(s21_empty[701], 1402);
+  EXPECT_EQ(s21_empty.size(), 100000);
+}
+
+TEST(MapCompareTest, testGreaterCompare) {
+  s21::Map<int, int, std::greater<int>> s21_map{{1, 1}, {3, 3}, {2, 2}};
+  std::map<int, int, std::greater<int>> std_map{{1, 1}, {3, 3}, {2, 2}};
+  auto std_iter = std_map.begin();
+  for (auto iter = s21_map.begin(); iter != s21_map.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  EXPECT_EQ(s21_map.at(2), 2);
+}
+
+TEST(MapCompareTest, testTransparentCompare) {
+  s21::Map<std::string, int, std::less<>> s21_map{{"CPU", 10}, {"GPU", 15}};
+  std::string_view key = "GPU";
+  EXPECT_TRUE(s21_map.contains(key));
+  EXPECT_EQ((*s21_map.find(key)).second, 15);
+  EXPECT_TRUE(s21_map.find(std::string_view("RAM")) == s21_map.end());
+}
+
+TEST(MapPoolTest, testPoolMap) {
+  s21::Map<int, std::string, std::less<int>,
+           s21::PoolAllocator<std::pair<const int, std::string>>>
+      s21_map;
+  for (int i = 0; i < 300; ++i) {
+    s21_map[i] = std::to_string(i);
+  }
+  EXPECT_EQ(s21_map.get_allocator().allocated(), 301);
+  EXPECT_EQ(s21_map.at(123), "123");
+  s21_map.erase(s21_map.find(123));
+  EXPECT_FALSE(s21_map.contains(123));
+  EXPECT_EQ(s21_map.get_allocator().allocated(), 300);
+}
+
+TEST(MapBulkTest, testRange) {
+  std::vector<std::pair<int, std::string>> values{
+      {3, "three"}, {1, "one"}, {2, "two"}, {1, "uno"}};
+  s21::Map<int, std::string> s21_bulk(values.begin(), values.end());
+  std::map<int, std::string> std_bulk(values.begin(), values.end());
+  EXPECT_EQ(s21_bulk.size(), std_bulk.size());
+  EXPECT_EQ(s21_bulk.at(1), std_bulk.at(1));
+  s21_bulk[4] = "four";
+  std_bulk[4] = "four";
+  auto std_iter = std_bulk.begin();
+  for (auto iter = s21_bulk.begin(); iter != s21_bulk.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+}
+
+TEST_F(MapTest, testMergeKeepsExisting) {
+  s21::Map<int, std::string> s21_merge = {{2, "other"}, {7, "seven"}};
+  std::map<int, std::string> std_merge = {{2, "other"}, {7, "seven"}};
+  s21_test.merge(s21_merge);
+  std_test.merge(std_merge);
+  EXPECT_EQ(s21_test.size(), std_test.size());
+  EXPECT_EQ(s21_merge.size(), std_merge.size());
+  EXPECT_EQ(s21_test.at(2), std_test.at(2));
+  EXPECT_EQ(s21_merge.at(2), std_merge.at(2));
+  EXPECT_EQ(s21_test.at(7), std_test.at(7));
+}
+
+TEST_F(MapTest, testExtractRekey) {
+  auto node = s21_test.extract(2);
+  EXPECT_EQ(node.key(), 2);
+  EXPECT_EQ(node.mapped(), "two");
+  node.key() = 20;
+  auto result = s21_test.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ((*result.position).first, 20);
+  EXPECT_FALSE(s21_test.contains(2));
+  EXPECT_EQ(s21_test.at(20), "two");
+  EXPECT_EQ(s21_test.size(), 6);
+}
+
+TEST_F(MapTest, testTryEmplace) {
+  auto result = s21_test.try_emplace(2, 3, 'x');
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ((*result.first).second, "two");
+  result = s21_test.try_emplace(7, 3, 'x');
+  EXPECT_TRUE(result.second);
+  EXPECT_EQ(s21_test.at(7), "xxx");
+
+  s21::Map<std::string, std::unique_ptr<int>> s21_owner;
+  auto ptr = std::make_unique<int>(1);
+  EXPECT_TRUE(s21_owner.try_emplace("one", std::move(ptr)).second);
+  EXPECT_EQ(ptr, nullptr);
+  ptr = std::make_unique<int>(2);
+  EXPECT_FALSE(s21_owner.try_emplace("one", std::move(ptr)).second);
+  std::string key = "one";
+  EXPECT_FALSE(s21_owner.emplace(key, std::move(ptr)).second);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(*ptr, 2);
+  EXPECT_EQ(*s21_owner["one"], 1);
+}
+
+TEST_F(MapTest, testEmplace) {
+  EXPECT_FALSE(s21_test.emplace(1, "uno").second);
+  EXPECT_FALSE(s21_test.emplace(std::make_pair(1, "uno")).second);
+  EXPECT_TRUE(s21_test.emplace(std::piecewise_construct,
+                               std::forward_as_tuple(8),
+                               std::forward_as_tuple(2, 'y'))
+                  .second);
+  auto iter = s21_test.emplace_hint(s21_test.end(), 9, "nine");
+  EXPECT_EQ((*iter).second, "nine");
+  EXPECT_EQ(s21_test.at(1), "one");
+  EXPECT_EQ(s21_test.at(8), "yy");
+  EXPECT_EQ(s21_test.size(), 8);
+}
+
+TEST_F(MapTest, testInsertWithHint) {
+  s21::Map<int, int> s21_map;
+  for (int i = 0; i < 100; ++i) {
+    s21_map.insert(s21_map.end(), std::make_pair(i, i * i));
+  }
+  auto iter = s21_map.try_emplace(s21_map.end(), 50, -1);
+  EXPECT_EQ((*iter).second, 2500);
+  auto added = s21_map.try_emplace(s21_map.end(), 100, -1);
+  EXPECT_EQ((*added).second, -1);
+  EXPECT_EQ(s21_map.size(), 101);
+  int key = 0;
+  for (auto item : s21_map) EXPECT_EQ(item.first, key++);
+}
+
+TEST_F(MapTest, testIteratorWrites) {
+  for (auto it = s21_test.begin(); it != s21_test.end(); ++it) {
+    it->second += "!";
+  }
+  for (auto &item : s21_test) item.second += "?";
+  EXPECT_EQ(s21_test.at(3), "three!?");
+  static_assert(std::is_trivially_copyable_v<decltype(s21_test.begin())>);
+}
+
+TEST_F(MapTest, testBTreeMap) {
+  s21::BTreeMap<std::string, int> s21_map;
+  std::map<std::string, int> std_map;
+  for (int i = 0; i < 2000; ++i) {
+    std::string key = std::to_string(i * 7 % 301);
+    s21_map[key] += i;
+    std_map[key] += i;
+    if (i % 5 == 0) {
+      auto iter = s21_map.find(key);
+      s21_map.erase(iter);
+      std_map.erase(key);
+    }
+  }
+  ASSERT_EQ(s21_map.size(), std_map.size());
+  auto iter = s21_map.begin();
+  for (auto &item : std_map) {
+    EXPECT_EQ(iter->first, item.first);
+    EXPECT_EQ(iter->second, item.second);
+    ++iter;
+  }
+  EXPECT_EQ(s21_map.at("42"), std_map.at("42"));
+  EXPECT_THROW(s21_map.at("-1"), std::out_of_range);
+  s21_map.insert_or_assign("42", -42);
+  EXPECT_EQ(s21_map.at("42"), -42);
+  EXPECT_FALSE(s21_map.try_emplace("42", 0).second);
+}
+
+TEST_F(MapTest, testFreeze) {
+  auto frozen = s21_test.freeze();
+  ASSERT_EQ(frozen.size(), s21_test.size());
+  auto iter = frozen.begin();
+  for (auto &item : s21_test) {
+    EXPECT_EQ(iter->first, item.first);
+    EXPECT_EQ(iter->second, item.second);
+    ++iter;
+  }
+  EXPECT_EQ(frozen.at(3), s21_test.at(3));
+  EXPECT_THROW(frozen.at(-100), std::out_of_range);
+  EXPECT_TRUE(frozen.contains(3));
+  s21::FrozenMap<std::string, int> counts{{"b", 2}, {"a", 1}, {"b", 3}};
+  EXPECT_EQ(counts.size(), 2);
+  EXPECT_EQ(counts.at("b"), 2);
+  EXPECT_EQ(counts.lower_bound("aa")->first, "b");
+}
+
+TEST_F(MapTest, testSplitJoin) {
+  auto s21_high = s21_test.split(4);
+  EXPECT_EQ(s21_test.size(), 3);
+  EXPECT_EQ(s21_high.size(), 3);
+  EXPECT_EQ(s21_high.at(4), "four");
+  EXPECT_THROW(s21_test.at(4), std::out_of_range);
+  s21_high.join(s21_test);
+  ASSERT_EQ(s21_high.size(), std_test.size());
+  auto iter = s21_high.begin();
+  for (auto &item : std_test) {
+    EXPECT_EQ(iter->first, item.first);
+    EXPECT_EQ(iter->second, item.second);
+    ++iter;
+  }
+  s21::Map<int, std::string> s21_overlap{{2, "dup"}};
+  EXPECT_THROW(s21_high.join(s21_overlap), std::invalid_argument);
+}
+
+TEST(MapParallelTest, testBuildAndMerge) {
+  std::vector<std::pair<int, int>> items;
+  for (int i = 0; i < 60000; ++i) items.emplace_back(i * 2, i);
+  s21::Map<int, int> s21_map(s21::Parallel(4), items.begin(), items.end());
+  s21::Map<int, int> s21_other;
+  for (int i = 0; i < 60000; ++i) s21_other.insert(i * 3, -i);
+  s21_map.merge(s21_other, s21::Parallel(4));
+  EXPECT_EQ(s21_map.size(), 60000 + 40000);
+  EXPECT_EQ(s21_other.size(), 20000);
+  EXPECT_EQ(s21_map.at(6), 3);
+  EXPECT_EQ(s21_map.at(9), -3);
+  EXPECT_EQ(s21_other.at(6), -2);
+}
+
+TEST_F(MapTest, testPersistentSnapshot) {
+  s21::PersistentMap<std::string, int> config{{"retries", 3}, {"port", 80}};
+  auto before = config.snapshot();
+  config["port"] = 8080;
+  config.insert_or_assign("timeout", 30);
+  for (auto &item : config) item.second += 1;
+  config.erase(config.find("retries"));
+  EXPECT_EQ(config.size(), 2);
+  EXPECT_EQ(config.at("port"), 8081);
+  EXPECT_EQ(config.at("timeout"), 31);
+  EXPECT_FALSE(config.contains("retries"));
+  const auto &old = before;
+  EXPECT_EQ(old.size(), 2);
+  EXPECT_EQ(old.at("port"), 80);
+  EXPECT_EQ(old.at("retries"), 3);
+  EXPECT_FALSE(old.contains("timeout"));
+  std::vector<s21::PersistentMap<std::string, int>> history;
+  for (int i = 0; i < 200; ++i) {
+    config[std::to_string(i % 50)] = i;
+    history.push_back(config.snapshot());
+  }
+  for (int i = 0; i < 200; ++i) {
+    const auto &snapshot = history[i];
+    EXPECT_EQ(snapshot.at(std::to_string(i % 50)), i);
+    EXPECT_EQ(snapshot.size(), 2 + std::min(i + 1, 50));
+  }
+}
+
+TEST(ConcurrentMapTest, testReadersSeeWholeUpdates) {
+  s21::ConcurrentMap<int, long> accounts;
+  for (int i = 0; i < 32; ++i) EXPECT_TRUE(accounts.insert(i, 100));
+  EXPECT_FALSE(accounts.insert(0, 5));
+  std::atomic<bool> done{false};
+  std::atomic<int> bad_reads{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&] {
+      do {
+        long total = 0;
+        accounts.for_each([&total](const auto &item) { total += item.second; });
+        if (total != 3200 || !accounts.get(7)) ++bad_reads;
+      } while (!done);
+    });
+  }
+  for (int i = 0; i < 2000; ++i) {
+    accounts.update([i](auto &items) {
+      items[i % 32] -= 5;
+      items[i * 7 % 32] += 5;
+    });
+  }
+  done = true;
+  for (auto &reader : readers) reader.join();
+  EXPECT_EQ(bad_reads, 0);
+  auto snapshot = accounts.snapshot();
+  accounts.insert_or_assign(3, -1);
+  EXPECT_EQ(accounts.get(3), -1);
+  EXPECT_NE(snapshot.at(3), -1);
+  EXPECT_EQ(accounts.erase(3), 1);
+  EXPECT_EQ(accounts.erase(3), 0);
+  EXPECT_EQ(accounts.get(3), std::nullopt);
+  EXPECT_EQ(accounts.size(), 31);
+  EXPECT_EQ(snapshot.size(), 32);
+}
+
+TEST_F(MapTest, testSkipListMap) {
+  s21::SkipListMap<std::string, int> s21_map{{"b", 2}, {"a", 1}, {"b", 3}};
+  EXPECT_EQ(s21_map.size(), 2);
+  EXPECT_EQ(s21_map.at("b"), 2);
+  s21_map["c"] = 3;
+  s21_map.insert_or_assign("a", 10);
+  for (auto &item : s21_map) item.second *= 2;
+  EXPECT_EQ(s21_map.at("a"), 20);
+  EXPECT_EQ(s21_map.at("c"), 6);
+  EXPECT_FALSE(s21_map.insert("c", 0).second);
+  s21_map.erase(s21_map.find("b"));
+  EXPECT_FALSE(s21_map.contains("b"));
+  auto node = s21_map.extract("c");
+  node.key() = "d";
+  s21_map.insert(std::move(node));
+  std::string keys;
+  for (const auto &item : s21_map) keys += item.first;
+  EXPECT_EQ(keys, "ad");
+  EXPECT_EQ((--s21_map.end())->second, 6);
+  EXPECT_THROW(s21_map.at("c"), std::out_of_range);
+}
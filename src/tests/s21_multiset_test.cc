@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <set>
+#include <vector>
 
 class MultisetTest : public ::testing::Test {
  protected:
@@ -561,3 +562,335 @@ TEST_F(MultisetTest, testEqualRange4) {
   }
   EXPECT_EQ(s21_count, std_count);
 }
+
+TEST_F(MultisetTest, testEqualRangeLarge) {
+  for (int i = 0; i < 100000; ++i) {
+    s21_empty.insert(i / 4);
+    std_empty.insert(i / 4);
+  }
+  for (int key = -1; key <= 25001; key += 1000) {
+    auto s21_res = s21_empty.equal_range(key);
+    auto std_res = std_empty.equal_range(key);
+    int s21_count = 0;
+    int std_count = 0;
+    for (; s21_res.first != s21_res.second; ++s21_res.first) {
+      EXPECT_EQ(*s21_res.first, key);
+      s21_count++;
+    }
+    for (; std_res.first != std_res.second; ++std_res.first) {
+      std_count++;
+    }
+    EXPECT_EQ(s21_count, std_count);
+    EXPECT_EQ(s21_empty.count(key), std_empty.count(key));
+  }
+  EXPECT_TRUE(s21_empty.lower_bound(25000) == s21_empty.end());
+  EXPECT_EQ(*s21_empty.upper_bound(-1), 0);
+}
+
+TEST(MultisetBulkTest, testRange) {
+  std::vector<int> values{5, 1, 3, 3, 9, 1, 1, 7, 5, 0};
+  s21::Multiset<int> s21_bulk(values.begin(), values.end());
+  std::multiset<int> std_bulk(values.begin(), values.end());
+  EXPECT_EQ(s21_bulk.size(), std_bulk.size());
+  EXPECT_EQ(s21_bulk.count(1), std_bulk.count(1));
+  s21_bulk.insert(3);
+  std_bulk.insert(3);
+  s21_bulk.erase(s21_bulk.find(1));
+  std_bulk.erase(std_bulk.find(1));
+  auto std_iter = std_bulk.begin();
+  for (auto iter = s21_bulk.begin(); iter != s21_bulk.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+}
+
+TEST_F(MultisetTest, testMergeOrder) {
+  s21::Multiset<int> s21_merge{3, 0, 8, 3, 1};
+  std::multiset<int> std_merge{3, 0, 8, 3, 1};
+  s21_int.merge(s21_merge);
+  std_int.merge(std_merge);
+  EXPECT_TRUE(s21_merge.empty());
+  EXPECT_EQ(s21_int.size(), std_int.size());
+  auto std_iter = std_int.begin();
+  for (auto iter = s21_int.begin(); iter != s21_int.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+}
+
+TEST_F(MultisetTest, testSplitJoin) {
+  s21::Multiset<int> s21_high = s21_int.split(3);
+  EXPECT_EQ(s21_int.size(), 2);
+  EXPECT_EQ(s21_high.size(), 6);
+  EXPECT_EQ(s21_high.count(3), 4);
+  EXPECT_EQ(*s21_high.begin(), 3);
+  s21::Multiset<int> s21_low{-4, 0, 1};
+  s21_int.join(s21_low);
+  std_int.insert({-4, 0, 1});
+  s21::Multiset<int> s21_inside{4};
+  EXPECT_THROW(s21_high.join(s21_inside), std::invalid_argument);
+  s21::Multiset<int> s21_top = s21_high.split(5);
+  s21_int.join(s21_high);
+  s21_int.join(s21_top);
+  EXPECT_TRUE(s21_high.empty() && s21_top.empty());
+  ASSERT_EQ(s21_int.size(), std_int.size());
+  EXPECT_TRUE(std::equal(std_int.begin(), std_int.end(), s21_int.begin()));
+}
+
+TEST_F(MultisetTest, testSetAlgebra) {
+  s21::Multiset<int> s21_other{3, 3, 5, 5, 8};
+  std::multiset<int> std_other{3, 3, 5, 5, 8};
+  auto expect = [](const s21::Multiset<int> &result,
+                   std::vector<int> std_result) {
+    ASSERT_EQ(result.size(), std_result.size());
+    EXPECT_TRUE(std::equal(std_result.begin(), std_result.end(),
+                           result.begin()));
+  };
+  std::vector<int> std_result;
+  std::set_union(std_int.begin(), std_int.end(), std_other.begin(),
+                 std_other.end(), std::back_inserter(std_result));
+  expect(s21_int.set_union(s21_other), std_result);
+  std_result.clear();
+  std::set_intersection(std_int.begin(), std_int.end(), std_other.begin(),
+                        std_other.end(), std::back_inserter(std_result));
+  expect(s21_int.set_intersection(s21_other), std_result);
+  std_result.clear();
+  std::set_difference(std_int.begin(), std_int.end(), std_other.begin(),
+                      std_other.end(), std::back_inserter(std_result));
+  expect(s21_int.set_difference(s21_other), std_result);
+  std_result.clear();
+  std::set_symmetric_difference(std_int.begin(), std_int.end(),
+                                std_other.begin(), std_other.end(),
+                                std::back_inserter(std_result));
+  expect(s21_int.set_symmetric_difference(s21_other), std_result);
+  EXPECT_EQ(s21_int.set_intersection(s21_other).count(3), 2);
+  EXPECT_EQ(s21_int.set_union(s21_other).count(3), 4);
+}
+
+TEST(MultisetParallelTest, testMergeKeepsOrder) {
+  std::vector<int> values;
+  for (int i = 0; i < 80000; ++i) values.push_back(i / 4);
+  s21::Multiset<int> s21_first(s21::Parallel(4), values.begin(),
+                               values.end());
+  s21::Multiset<int> s21_second(values.begin(), values.end());
+  std::multiset<int> std_first(values.begin(), values.end());
+  std_first.insert(values.begin(), values.end());
+  EXPECT_EQ(s21_first.count(777), 4);
+  s21::Multiset<int> s21_common =
+      s21_first.set_intersection(s21_second, s21::Parallel(4));
+  EXPECT_EQ(s21_common.size(), values.size());
+  s21_first.merge(s21_second, s21::Parallel(4));
+  EXPECT_TRUE(s21_second.empty());
+  ASSERT_EQ(s21_first.size(), std_first.size());
+  EXPECT_TRUE(std::equal(std_first.begin(), std_first.end(),
+                         s21_first.begin()));
+}
+
+TEST_F(MultisetTest, testExtractInsert) {
+  auto node = s21_int.extract(3);
+  EXPECT_EQ(node.value(), 3);
+  EXPECT_EQ(s21_int.count(3), 3);
+  auto iter = s21_empty.insert(std::move(node));
+  EXPECT_EQ(*iter, 3);
+  s21_empty.insert(s21_int.extract(s21_int.find(3)));
+  EXPECT_EQ(s21_empty.count(3), 2);
+  EXPECT_EQ(s21_int.count(3), 2);
+  EXPECT_EQ(s21_int.size(), 6);
+}
+
+TEST_F(MultisetTest, testEmplace) {
+  auto iter = s21_int.emplace(3);
+  EXPECT_EQ(*iter, 3);
+  EXPECT_EQ(s21_int.count(3), 5);
+  EXPECT_EQ(*++iter, 5);
+  auto hinted = s21_empty.emplace_hint(s21_empty.end(), 1);
+  EXPECT_EQ(*hinted, 1);
+  EXPECT_EQ(s21_empty.size(), 1);
+}
+
+TEST_F(MultisetTest, testInsertWithHint) {
+  auto iter = s21_int.insert(s21_int.find(3), 3);
+  EXPECT_EQ(*iter, 3);
+  s21_int.insert(s21_int.end(), 9);
+  s21_int.insert(s21_int.begin(), 9);
+  s21_int.insert(s21_int.begin(), 0);
+  EXPECT_EQ(s21_int.count(3), 5);
+  EXPECT_EQ(s21_int.count(9), 2);
+  std::multiset<int> std_int{3, 3, 2, 5, 7, 3, 1, 3, 3, 9, 9, 0};
+  EXPECT_TRUE(std::equal(std_int.begin(), std_int.end(), s21_int.begin()));
+}
+
+TEST_F(MultisetTest, testNthRank) {
+  std::multiset<int> std_int{3, 3, 2, 5, 7, 3, 1, 3};
+  std::size_t k = 0;
+  for (auto value : std_int) EXPECT_EQ(*s21_int.nth(k++), value);
+  EXPECT_EQ(s21_int.rank(3), 2);
+  EXPECT_EQ(s21_int.rank(4), 6);
+  EXPECT_EQ(s21_int.count_range(2, 5), 5);
+  EXPECT_EQ(s21_int.count_range(3, 3), 0);
+  s21_int.erase(s21_int.find(3));
+  s21_int.insert(s21_int.end(), 8);
+  EXPECT_EQ(*s21_int.nth(7), 8);
+  EXPECT_EQ(*s21_int.nth(4), 3);
+  EXPECT_EQ(s21_int.count_range(0, 100), 8);
+  EXPECT_EQ(s21_int.count(3), 3);
+}
+
+TEST(CompactMultisetTest, testMatchesMultiset) {
+  std::vector<int> values;
+  for (int i = 0; i < 2000; ++i) values.push_back(i * 7 % 13);
+  s21::CompactMultiset<int> s21_compact(values.begin(), values.end());
+  std::multiset<int> std_multiset(values.begin(), values.end());
+  s21_compact.insert(5);
+  s21_compact.insert(s21_compact.end(), 20);
+  s21_compact.emplace(-1);
+  std_multiset.insert({5, 20, -1});
+
+  EXPECT_EQ(s21_compact.size(), std_multiset.size());
+  EXPECT_TRUE(std::equal(std_multiset.begin(), std_multiset.end(),
+                         s21_compact.begin(), s21_compact.end()));
+  EXPECT_EQ(s21_compact.count(5), std_multiset.count(5));
+  EXPECT_EQ(s21_compact.count(100), 0);
+  EXPECT_EQ(*--s21_compact.end(), 20);
+  EXPECT_EQ(*s21_compact.upper_bound(-1), 0);
+
+  auto range = s21_compact.equal_range(3);
+  EXPECT_EQ(std::distance(range.first, range.second),
+            static_cast<long>(std_multiset.count(3)));
+  s21_compact.erase(s21_compact.find(3));
+  EXPECT_EQ(s21_compact.count(3), std_multiset.count(3) - 1);
+  s21_compact.erase(s21_compact.find(-1));
+  EXPECT_FALSE(s21_compact.contains(-1));
+  EXPECT_EQ(s21_compact.count(-1), 0);
+  EXPECT_EQ(s21_compact.size(), std_multiset.size() - 2);
+}
+
+TEST(CompactMultisetTest, testOneNodePerKey) {
+  using PoolCompact = s21::CompactMultiset<int, std::less<int>,
+                                           s21::PoolAllocator<int>>;
+  PoolCompact s21_compact;
+  for (int i = 0; i < 10000; ++i) s21_compact.insert(i % 10);
+  EXPECT_EQ(s21_compact.size(), 10000);
+  EXPECT_EQ(s21_compact.get_allocator().allocated(), 11);
+
+  PoolCompact s21_other(s21_compact.get_allocator());
+  s21_other.insert(3);
+  s21_other.insert(42);
+  s21_compact.merge(s21_other);
+  EXPECT_TRUE(s21_other.empty());
+  EXPECT_EQ(s21_compact.count(3), 1001);
+  EXPECT_EQ(s21_compact.count(42), 1);
+  EXPECT_EQ(s21_compact.size(), 10002);
+  EXPECT_EQ(s21_compact.get_allocator().allocated(), 13);
+}
+
+TEST(BTreeMultisetTest, testMatchesMultiset) {
+  s21::BTreeMultiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 5000; ++i) {
+    int value = i * 13 % 97;
+    if (i % 4 == 3) {
+      auto iter = s21_multiset.find(value);
+      if (iter != s21_multiset.end()) {
+        s21_multiset.erase(iter);
+        std_multiset.erase(std_multiset.find(value));
+      }
+    } else {
+      s21_multiset.insert(value);
+      std_multiset.insert(value);
+    }
+  }
+  ASSERT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(std::equal(std_multiset.begin(), std_multiset.end(),
+                         s21_multiset.begin()));
+  EXPECT_EQ(s21_multiset.count(5), std_multiset.count(5));
+  EXPECT_EQ(*s21_multiset.lower_bound(50), *std_multiset.lower_bound(50));
+  EXPECT_EQ(*s21_multiset.upper_bound(50), *std_multiset.upper_bound(50));
+  auto range = s21_multiset.equal_range(7);
+  EXPECT_EQ(std::distance(range.first, range.second),
+            static_cast<long>(std_multiset.count(7)));
+}
+
+template <class T>
+void ExpectBoundsMatch(const std::vector<T> &values,
+                       const std::vector<T> &probes) {
+  s21::BTreeMultiset<T> s21_multiset(values.begin(), values.end());
+  std::multiset<T> std_multiset(values.begin(), values.end());
+  for (T probe : probes) {
+    auto lower = s21_multiset.lower_bound(probe);
+    auto upper = s21_multiset.upper_bound(probe);
+    auto std_lower = std_multiset.lower_bound(probe);
+    auto std_upper = std_multiset.upper_bound(probe);
+    ASSERT_EQ(lower == s21_multiset.end(), std_lower == std_multiset.end());
+    ASSERT_EQ(upper == s21_multiset.end(), std_upper == std_multiset.end());
+    if (std_lower != std_multiset.end()) {
+      EXPECT_EQ(*lower, *std_lower);
+    }
+    if (std_upper != std_multiset.end()) {
+      EXPECT_EQ(*upper, *std_upper);
+    }
+    EXPECT_EQ(s21_multiset.count(probe), std_multiset.count(probe));
+  }
+}
+
+TEST(BTreeMultisetTest, testPackedKeySearch) {
+  std::vector<int32_t> ints;
+  std::vector<int64_t> longs;
+  std::vector<uint64_t> unsigned_longs;
+  std::vector<double> doubles;
+  for (int i = -2000; i < 2000; i += 3) {
+    ints.push_back(i);
+    longs.push_back(static_cast<int64_t>(i) * (int64_t(1) << 40));
+    unsigned_longs.push_back(static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15u);
+    doubles.push_back(i / 7.0);
+  }
+  std::vector<int32_t> int_probes{INT32_MIN, -2001, -2000, -1,   0,   1,
+                                  6,         7,     1997,  1998, INT32_MAX};
+  std::vector<int64_t> long_probes{INT64_MIN, -1, 0, int64_t(7) << 40,
+                                   INT64_MAX};
+  std::vector<uint64_t> unsigned_probes{0, 1, uint64_t(1) << 63,
+                                        unsigned_longs[10], UINT64_MAX};
+  std::vector<double> double_probes{-1e9, -285.0, doubles[100], 0.0,
+                                    doubles[500] + 1e-9, 1e9};
+  ExpectBoundsMatch(ints, int_probes);
+  ExpectBoundsMatch(ints, ints);
+  ints.insert(ints.end(), 40, 7);
+  ExpectBoundsMatch(ints, int_probes);
+  ExpectBoundsMatch(longs, long_probes);
+  ExpectBoundsMatch(unsigned_longs, unsigned_probes);
+  ExpectBoundsMatch(unsigned_longs, unsigned_longs);
+  ExpectBoundsMatch(doubles, double_probes);
+  ExpectBoundsMatch(doubles, doubles);
+}
+
+TEST(SkipListMultisetTest, testMatchesMultiset) {
+  s21::SkipListMultiset<int> s21_multiset;
+  std::multiset<int> std_multiset;
+  for (int i = 0; i < 5000; ++i) {
+    int value = i * 13 % 97;
+    if (i % 4 == 3) {
+      auto iter = s21_multiset.find(value);
+      if (iter != s21_multiset.end()) {
+        s21_multiset.erase(iter);
+        std_multiset.erase(std_multiset.find(value));
+      }
+    } else {
+      s21_multiset.insert(value);
+      std_multiset.insert(value);
+    }
+  }
+  ASSERT_EQ(s21_multiset.size(), std_multiset.size());
+  EXPECT_TRUE(std::equal(std_multiset.begin(), std_multiset.end(),
+                         s21_multiset.begin()));
+  EXPECT_TRUE(std::equal(std_multiset.rbegin(), std_multiset.rend(),
+                         std::make_reverse_iterator(s21_multiset.end())));
+  EXPECT_EQ(s21_multiset.count(5), std_multiset.count(5));
+  auto range = s21_multiset.equal_range(7);
+  EXPECT_EQ(std::distance(range.first, range.second),
+            static_cast<long>(std_multiset.count(7)));
+  s21::SkipListMultiset<int> s21_other{7, 7, 200};
+  s21_multiset.merge(s21_other);
+  EXPECT_TRUE(s21_other.empty());
+  EXPECT_EQ(s21_multiset.count(7), std_multiset.count(7) + 2);
+  EXPECT_EQ(*--s21_multiset.end(), 200);
+}
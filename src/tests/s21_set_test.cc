@@ -1,9 +1,15 @@
+#include "../s21_concurrent.h"
 #include "../s21_set/s21_set.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <set>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 class SetTest : public ::testing::Test {
  protected:
@@ -242,6 +248,7 @@ TEST_F(SetTest, testInsert1) {
   EXPECT_EQ(*s21_it.first, *std_it.first);
   EXPECT_EQ(*s21_it2.first, *std_it2.first);
   EXPECT_EQ(s21_it.second, std_it.second);
+  EXPECT_FALSE(s21_it3.second);
   EXPECT_EQ(s21_empty.size(), std_empty.size());
 
   auto s21_iter = s21_empty.begin();
@@ -414,3 +421,1019 @@ TEST_F(SetTest, testContains) {
   EXPECT_TRUE(s21_const.contains('s'));
   EXPECT_FALSE(s21_const.contains('w'));
 }
+
+// Checks the red-black invariants below node, whose parent is red if
+// parent_red is set: no red node has a red child, and every path down
+// meets the same number of black nodes, which is returned. depth tracks
+// the longest path in nodes.
+template <class Node>
+int CheckRedBlack(const Node *node, bool parent_red, int depth,
+                  int &max_depth) {
+  if (node == nullptr || node->is_fake) {
+    max_depth = std::max(max_depth, depth);
+    return 0;
+  }
+  EXPECT_FALSE(parent_red && node->is_red);
+  int left = CheckRedBlack(node->left, node->is_red, depth + 1, max_depth);
+  int right = CheckRedBlack(node->right, node->is_red, depth + 1, max_depth);
+  EXPECT_EQ(left, right);
+  return left + !node->is_red;
+}
+
+// The height of a red-black tree of n nodes is at most 2 log2(n + 1).
+template <class Set>
+void ExpectBalanced(const Set &set) {
+  const auto *root = set.begin().get();
+  while (root->parent) root = root->parent;
+  EXPECT_FALSE(root->is_red);
+  int max_depth = 0;
+  CheckRedBlack(root, false, 0, max_depth);
+  EXPECT_LE(max_depth, 2 * std::log2(set.size() + 1.0));
+}
+
+TEST(SetBalanceTest, testSortedInsertErase) {
+  s21::Set<int> s21_sorted;
+  std::set<int> std_sorted;
+  for (int i = 0; i < 200000; ++i) {
+    s21_sorted.insert(i);
+    std_sorted.insert(i);
+  }
+  for (int i = 199999; i >= 0; i -= 3) {
+    s21_sorted.erase(s21_sorted.find(i));
+    std_sorted.erase(i);
+  }
+  ExpectBalanced(s21_sorted);
+  s21::Set<int> s21_copy(s21_sorted);
+  s21_copy.insert(-1);
+  std_sorted.insert(-1);
+  ExpectBalanced(s21_copy);
+
+  EXPECT_EQ(s21_copy.size(), std_sorted.size());
+  auto std_iter = std_sorted.begin();
+  for (auto iter = s21_copy.begin(); iter != s21_copy.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  EXPECT_EQ(*--s21_copy.end(), *--std_sorted.end());
+}
+
+struct ModuloLess {
+  int mod = 10;
+  bool operator()(int lhs, int rhs) const { return lhs % mod < rhs % mod; }
+};
+
+TEST(SetCompareTest, testStatefulCompare) {
+  s21::Set<int, ModuloLess> s21_mod(ModuloLess{5});
+  std::set<int, ModuloLess> std_mod(ModuloLess{5});
+  for (int i : {7, 3, 12, 9, 5, 21, 14}) {
+    EXPECT_EQ(s21_mod.insert(i).second, std_mod.insert(i).second);
+  }
+  EXPECT_EQ(s21_mod.size(), std_mod.size());
+  auto std_iter = std_mod.begin();
+  for (auto iter = s21_mod.begin(); iter != s21_mod.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  EXPECT_TRUE(s21_mod.contains(17));
+  EXPECT_EQ(s21_mod.key_comp().mod, 5);
+}
+
+TEST(SetCompareTest, testTransparentCompare) {
+  s21::Set<std::string, std::less<>> s21_names{"bob", "alice", "carol"};
+  std::string_view name = "alice";
+  EXPECT_TRUE(s21_names.contains(name));
+  EXPECT_EQ(*s21_names.find(name), "alice");
+  EXPECT_FALSE(s21_names.contains(std::string_view("dave")));
+  EXPECT_TRUE(s21_names.find(std::string_view("dave")) == s21_names.end());
+}
+
+TEST(SetCompareTest, testEmptyCompareTakesNoSpace) {
+  EXPECT_EQ(sizeof(s21::Set<int>), 3 * sizeof(void *));
+  EXPECT_EQ(sizeof(s21::Set<int, ModuloLess>),
+            sizeof(s21::Set<int>) + sizeof(void *));
+}
+
+TEST(SetPoolTest, testPoolRecyclesNodes) {
+  using PoolSet = s21::Set<int, std::less<int>, s21::PoolAllocator<int, 64>>;
+  PoolSet s21_pool;
+  std::set<int> std_pool;
+  for (int i = 0; i < 1000; ++i) {
+    s21_pool.insert(i * 7 % 1000);
+    std_pool.insert(i * 7 % 1000);
+  }
+  auto alloc = s21_pool.get_allocator();
+  EXPECT_EQ(alloc.allocated(), 1001);
+  EXPECT_EQ(alloc.capacity(), 1024);
+
+  for (int i = 0; i < 1000; i += 2) {
+    s21_pool.erase(s21_pool.find(i));
+    std_pool.erase(i);
+  }
+  EXPECT_EQ(alloc.allocated(), 501);
+  for (int i = 1000; i < 1500; ++i) {
+    s21_pool.insert(i);
+    std_pool.insert(i);
+  }
+  EXPECT_EQ(alloc.allocated(), 1001);
+  EXPECT_EQ(alloc.capacity(), 1024);
+
+  auto std_iter = std_pool.begin();
+  for (auto iter = s21_pool.begin(); iter != s21_pool.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  s21_pool.clear();
+  EXPECT_EQ(alloc.allocated(), 1);
+  EXPECT_FALSE(alloc.release());
+}
+
+TEST(SetPoolTest, testSharedPool) {
+  using PoolSet = s21::Set<std::string, std::less<std::string>,
+                           s21::PoolAllocator<std::string>>;
+  s21::PoolAllocator<std::string> pool;
+  {
+    PoolSet first(std::less<std::string>(), pool);
+    PoolSet second(pool);
+    first.insert("one");
+    second.insert("two");
+    second.insert("three");
+    EXPECT_EQ(pool.allocated(), 5);
+    first.swap(second);
+    PoolSet copy(first);
+    EXPECT_EQ(pool.allocated(), 8);
+    EXPECT_TRUE(copy.contains("three"));
+    EXPECT_TRUE(second.contains("one"));
+  }
+  EXPECT_EQ(pool.allocated(), 0);
+  EXPECT_TRUE(pool.release());
+  EXPECT_EQ(pool.capacity(), 0);
+}
+
+TEST(SetBulkTest, testSortedRange) {
+  std::vector<int> values;
+  for (int i = 0; i < 100000; ++i) values.push_back(i * 2);
+  s21::Set<int> s21_bulk(values.begin(), values.end());
+  std::set<int> std_bulk(values.begin(), values.end());
+  EXPECT_EQ(s21_bulk.size(), std_bulk.size());
+
+  for (int i = 0; i < 100000; i += 3) {
+    s21_bulk.insert(i * 2 + 1);
+    std_bulk.insert(i * 2 + 1);
+    s21_bulk.erase(s21_bulk.find(i * 2));
+    std_bulk.erase(i * 2);
+  }
+  auto std_iter = std_bulk.begin();
+  for (auto iter = s21_bulk.begin(); iter != s21_bulk.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  EXPECT_EQ(*--s21_bulk.end(), *--std_bulk.end());
+}
+
+TEST(SetBulkTest, testUnsortedRange) {
+  std::vector<std::string> values{"d", "b", "a", "d", "c", "b", "e"};
+  s21::Set<std::string> s21_bulk(values.begin(), values.end());
+  std::set<std::string> std_bulk(values.begin(), values.end());
+  EXPECT_EQ(s21_bulk.size(), std_bulk.size());
+  auto std_iter = std_bulk.begin();
+  for (auto iter = s21_bulk.begin(); iter != s21_bulk.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  s21::Set<std::string> s21_empty(values.begin(), values.begin());
+  EXPECT_TRUE(s21_empty.empty());
+  EXPECT_TRUE(s21_empty.begin() == s21_empty.end());
+}
+
+TEST(SetMergeTest, testMergeLeavesDuplicates) {
+  s21::Set<int> s21_first{1, 3, 5, 7, 9};
+  s21::Set<int> s21_second{0, 3, 4, 9, 10};
+  std::set<int> std_first{1, 3, 5, 7, 9};
+  std::set<int> std_second{0, 3, 4, 9, 10};
+  s21_first.merge(s21_second);
+  std_first.merge(std_second);
+
+  EXPECT_EQ(s21_first.size(), std_first.size());
+  EXPECT_EQ(s21_second.size(), std_second.size());
+  auto std_iter = std_first.begin();
+  for (auto iter = s21_first.begin(); iter != s21_first.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  std_iter = std_second.begin();
+  for (auto iter = s21_second.begin(); iter != s21_second.end(); ++iter) {
+    EXPECT_EQ(*iter, *std_iter);
+    ++std_iter;
+  }
+  s21_second.insert(100);
+  s21_first.erase(s21_first.find(5));
+  EXPECT_EQ(s21_second.size(), 3);
+  EXPECT_EQ(s21_first.size(), 7);
+}
+
+TEST(SetMergeTest, testMergeSplicesPoolNodes) {
+  using PoolSet = s21::Set<int, std::less<int>, s21::PoolAllocator<int>>;
+  s21::PoolAllocator<int> pool;
+  PoolSet s21_first(pool);
+  PoolSet s21_second(pool);
+  PoolSet s21_other;
+  for (int i = 0; i < 1000; ++i) {
+    s21_first.insert(i * 2);
+    s21_second.insert(i * 3);
+    s21_other.insert(i * 5);
+  }
+  EXPECT_EQ(pool.allocated(), 2002);
+  s21_first.merge(s21_second);
+  EXPECT_EQ(pool.allocated(), 2002);
+  EXPECT_EQ(s21_first.size() + s21_second.size(), 2000);
+
+  std::size_t size_before = s21_first.size();
+  s21_first.merge(s21_other);
+  EXPECT_EQ(s21_first.size() + s21_second.size() + s21_other.size(), 3000);
+  EXPECT_EQ(pool.allocated(), 2002 + s21_first.size() - size_before);
+  int prev = -1;
+  for (auto iter = s21_first.begin(); iter != s21_first.end(); ++iter) {
+    EXPECT_LT(prev, *iter);
+    prev = *iter;
+  }
+}
+
+TEST(SetSplitTest, testSplitJoin) {
+  s21::Set<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 1000; ++i) {
+    s21_set.insert(i * 7 % 1009);
+    std_set.insert(i * 7 % 1009);
+  }
+  s21::Set<int> s21_high = s21_set.split(500);
+  ASSERT_EQ(s21_set.size(), std::distance(std_set.begin(),
+                                          std_set.lower_bound(500)));
+  ASSERT_EQ(s21_set.size() + s21_high.size(), std_set.size());
+  EXPECT_TRUE(std::equal(s21_set.begin(), s21_set.end(), std_set.begin()));
+  EXPECT_TRUE(std::equal(s21_high.begin(), s21_high.end(),
+                         std_set.lower_bound(500)));
+  EXPECT_EQ(*s21_high.nth(0), 500);
+  EXPECT_EQ(*--s21_set.end(), 499);
+
+  s21::Set<int> s21_empty = s21_high.split(-1);
+  EXPECT_TRUE(s21_high.empty());
+  s21_high.join(s21_empty);
+  EXPECT_TRUE(s21_empty.empty());
+  s21_high.join(s21_set);
+  EXPECT_TRUE(s21_set.empty());
+  ASSERT_EQ(s21_high.size(), std_set.size());
+  EXPECT_TRUE(std::equal(s21_high.begin(), s21_high.end(), std_set.begin()));
+  EXPECT_EQ(*s21_high.nth(700), *std::next(std_set.begin(), 700));
+
+  s21::Set<int> s21_overlap{3, 2000};
+  EXPECT_THROW(s21_high.join(s21_overlap), std::invalid_argument);
+  EXPECT_EQ(s21_overlap.size(), 2);
+  EXPECT_EQ(s21_high.size(), std_set.size());
+}
+
+TEST(SetSplitTest, testThreadedAndPool) {
+  using PoolSet = s21::Set<int, std::less<int>, s21::PoolAllocator<int>,
+                           s21::ThreadedTree<int, std::less<int>,
+                                             s21::PoolAllocator<int>>>;
+  s21::PoolAllocator<int> pool;
+  PoolSet s21_set(pool);
+  PoolSet s21_other;
+  std::set<int> std_set;
+  for (int i = 0; i < 300; ++i) {
+    s21_set.insert(i);
+    s21_other.insert(i + 1000);
+    std_set.insert({i, i + 1000});
+  }
+  PoolSet s21_high = s21_set.split(100);
+  s21_high.join(s21_other);
+  EXPECT_EQ(pool.allocated(), 602);
+  s21_set.join(s21_high);
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_set.end())));
+}
+
+TEST(SetAlgebraTest, testMatchesStd) {
+  s21::Set<int> s21_first;
+  s21::Set<int> s21_second;
+  std::set<int> std_first;
+  std::set<int> std_second;
+  for (int i = 0; i < 600; ++i) {
+    s21_first.insert(i * 3 % 700);
+    std_first.insert(i * 3 % 700);
+    s21_second.insert(i * 5 % 900);
+    std_second.insert(i * 5 % 900);
+  }
+  auto expect = [](const s21::Set<int> &result, std::vector<int> std_result) {
+    ASSERT_EQ(result.size(), std_result.size());
+    EXPECT_TRUE(std::equal(std_result.begin(), std_result.end(),
+                           result.begin()));
+    for (size_t k = 0; k < std_result.size(); k += 97) {
+      EXPECT_EQ(*result.nth(k), std_result[k]);
+    }
+  };
+  std::vector<int> std_result;
+  std::set_union(std_first.begin(), std_first.end(), std_second.begin(),
+                 std_second.end(), std::back_inserter(std_result));
+  expect(s21_first.set_union(s21_second), std_result);
+  std_result.clear();
+  std::set_intersection(std_first.begin(), std_first.end(),
+                        std_second.begin(), std_second.end(),
+                        std::back_inserter(std_result));
+  expect(s21_first.set_intersection(s21_second), std_result);
+  std_result.clear();
+  std::set_difference(std_first.begin(), std_first.end(), std_second.begin(),
+                      std_second.end(), std::back_inserter(std_result));
+  expect(s21_first.set_difference(s21_second), std_result);
+  std_result.clear();
+  std::set_symmetric_difference(std_first.begin(), std_first.end(),
+                                std_second.begin(), std_second.end(),
+                                std::back_inserter(std_result));
+  expect(s21_first.set_symmetric_difference(s21_second), std_result);
+  EXPECT_EQ(s21_first.size(), std_first.size());
+}
+
+TEST(SetAlgebraTest, testVeryDifferentSizes) {
+  s21::Set<int> s21_large;
+  for (int i = 0; i < 100000; ++i) s21_large.insert(i * 2);
+  s21::Set<int> s21_small{-5, 4, 7, 1000, 99998, 200001};
+  s21::Set<int> s21_common = s21_small.set_intersection(s21_large);
+  EXPECT_EQ(s21_common.size(), 3);
+  EXPECT_TRUE(s21_common.contains(99998));
+  s21::Set<int> s21_rest = s21_small.set_difference(s21_large);
+  std::vector<int> expected{-5, 7, 200001};
+  ASSERT_EQ(s21_rest.size(), expected.size());
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(), s21_rest.begin()));
+  EXPECT_EQ(s21_large.set_difference(s21_small).size(), 100000 - 3);
+  EXPECT_EQ(s21_large.set_union(s21_small).size(), 100000 + 3);
+  EXPECT_TRUE(s21::Set<int>().set_intersection(s21_large).empty());
+}
+
+TEST(SetParallelTest, testMatchesSequential) {
+  std::vector<int> sorted;
+  std::vector<int> shuffled;
+  for (int i = 0; i < 100000; ++i) {
+    sorted.push_back(i * 3);
+    shuffled.push_back(i * 7919 % 150001);
+  }
+  s21::Set<int> s21_first(sorted.begin(), sorted.end());
+  s21::Set<int> s21_second(shuffled.begin(), shuffled.end());
+  for (unsigned threads : {1u, 3u, 8u}) {
+    s21::Parallel policy(threads);
+    s21::Set<int> s21_par_first(policy, sorted.begin(), sorted.end());
+    s21::Set<int> s21_par_second(policy, shuffled.begin(), shuffled.end());
+    ASSERT_EQ(s21_par_second.size(), s21_second.size());
+    EXPECT_TRUE(std::equal(s21_second.begin(), s21_second.end(),
+                           s21_par_second.begin()));
+    EXPECT_EQ(*s21_par_first.nth(54321), 54321 * 3);
+
+    auto expect_equal = [](const s21::Set<int> &lhs,
+                           const s21::Set<int> &rhs) {
+      ASSERT_EQ(lhs.size(), rhs.size());
+      EXPECT_TRUE(std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+    };
+    expect_equal(s21_first.set_union(s21_second),
+                 s21_par_first.set_union(s21_par_second, policy));
+    expect_equal(s21_first.set_intersection(s21_second),
+                 s21_par_first.set_intersection(s21_par_second, policy));
+    expect_equal(s21_second.set_difference(s21_first),
+                 s21_par_second.set_difference(s21_par_first, policy));
+    expect_equal(
+        s21_first.set_symmetric_difference(s21_second),
+        s21_par_first.set_symmetric_difference(s21_par_second, policy));
+
+    s21::Set<int> s21_merged(s21_first);
+    s21::Set<int> s21_rest(s21_second);
+    s21_merged.merge(s21_rest);
+    s21_par_first.merge(s21_par_second, policy);
+    expect_equal(s21_merged, s21_par_first);
+    expect_equal(s21_rest, s21_par_second);
+  }
+}
+
+TEST(SetParallelTest, testPoolAllocatesOnOneThread) {
+  using PoolSet = s21::Set<int, std::less<int>, s21::PoolAllocator<int>>;
+  std::vector<int> values(70000);
+  for (int i = 0; i < 70000; ++i) values[i] = i;
+  PoolSet s21_set(s21::Parallel(4), values.begin(), values.end());
+  PoolSet s21_odd(s21::Parallel(4), values.begin() + 1, values.end());
+  EXPECT_EQ(s21_set.size(), 70000);
+  EXPECT_EQ(s21_set.set_difference(s21_odd, s21::Parallel(4)).size(), 1);
+  s21_set.merge(s21_odd, s21::Parallel(4));
+  EXPECT_EQ(s21_odd.size(), 69999);
+}
+
+TEST(SetNodeTest, testExtractInsert) {
+  using PoolSet = s21::Set<std::string, std::less<std::string>,
+                           s21::PoolAllocator<std::string>>;
+  s21::PoolAllocator<std::string> pool;
+  PoolSet s21_first(pool);
+  PoolSet s21_second(pool);
+  for (auto name : {"a", "b", "c", "d"}) s21_first.insert(name);
+  s21_second.insert("c");
+  std::size_t allocated = pool.allocated();
+
+  auto node = s21_first.extract("b");
+  EXPECT_FALSE(node.empty());
+  EXPECT_EQ(node.value(), "b");
+  EXPECT_FALSE(s21_first.contains("b"));
+  auto result = s21_second.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(*result.position, "b");
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_TRUE(node.empty());
+
+  auto taken = s21_first.extract(s21_first.find("c"));
+  auto clash = s21_second.insert(std::move(taken));
+  EXPECT_FALSE(clash.inserted);
+  EXPECT_EQ(*clash.position, "c");
+  EXPECT_EQ(clash.node.value(), "c");
+  EXPECT_EQ(pool.allocated(), allocated);
+
+  clash.node.value() = "e";
+  EXPECT_TRUE(s21_first.insert(std::move(clash.node)).inserted);
+  EXPECT_EQ(s21_first.size(), 3);
+  EXPECT_EQ(s21_second.size(), 2);
+  EXPECT_EQ(*--s21_first.end(), "e");
+  EXPECT_TRUE(s21_first.extract("z").empty());
+  EXPECT_EQ(pool.allocated(), allocated);
+}
+
+TEST(SetNodeTest, testInsertFromOtherPool) {
+  using PoolSet = s21::Set<int, std::less<int>, s21::PoolAllocator<int>>;
+  PoolSet s21_first{1, 2, 3};
+  PoolSet s21_second{4};
+  s21_second.insert(s21_first.extract(2));
+  EXPECT_EQ(s21_first.get_allocator().allocated(), 3);
+  EXPECT_EQ(s21_second.get_allocator().allocated(), 3);
+  EXPECT_TRUE(s21_second.contains(2));
+}
+
+struct Tracked {
+  static int built;
+  int key = 0;
+
+  Tracked() {}
+  explicit Tracked(int k) : key(k) { ++built; }
+  Tracked(const Tracked &other) : key(other.key) { ++built; }
+  Tracked &operator=(const Tracked &other) = default;
+  bool operator<(const Tracked &other) const { return key < other.key; }
+};
+
+int Tracked::built = 0;
+
+TEST(SetEmplaceTest, testBuildsInPlace) {
+  s21::Set<Tracked> s21_set;
+  Tracked::built = 0;
+  EXPECT_TRUE(s21_set.emplace(5).second);
+  EXPECT_EQ(Tracked::built, 1);
+
+  Tracked five(5);
+  Tracked::built = 0;
+  EXPECT_FALSE(s21_set.emplace(five).second);
+  EXPECT_FALSE(s21_set.insert(five).second);
+  EXPECT_EQ(Tracked::built, 0);
+
+  s21_set.emplace_hint(s21_set.end(), 7);
+  EXPECT_EQ(Tracked::built, 1);
+  EXPECT_FALSE(s21_set.emplace(7).second);
+  EXPECT_EQ(s21_set.size(), 2);
+  EXPECT_TRUE(s21_set.contains(Tracked(7)));
+}
+
+TEST(SetEmplaceTest, testMoveOnly) {
+  s21::Set<std::string> s21_set;
+  std::string word = "word";
+  EXPECT_TRUE(s21_set.insert(std::move(word)).second);
+  std::string again = "word";
+  EXPECT_FALSE(s21_set.insert(std::move(again)).second);
+  EXPECT_EQ(again, "word");
+  EXPECT_TRUE(s21_set.emplace(3, 'x').second);
+  EXPECT_TRUE(s21_set.contains("xxx"));
+}
+
+TEST(SetHintTest, testInsertWithHint) {
+  s21::Set<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_EQ(*s21_set.insert(s21_set.end(), i), i);
+    std_set.insert(std_set.end(), i);
+  }
+  for (int i = 999; i > 0; i -= 2) {
+    EXPECT_EQ(*s21_set.insert(s21_set.begin(), i), i);
+    std_set.insert(i);
+  }
+  EXPECT_EQ(*s21_set.insert(s21_set.begin(), 5000), 5000);
+  EXPECT_EQ(*s21_set.insert(s21_set.end(), -1), -1);
+  std_set.insert({5000, -1});
+  EXPECT_EQ(*s21_set.insert(s21_set.find(10), 10), 10);
+  EXPECT_EQ(*s21_set.emplace_hint(s21_set.find(12), 11), 11);
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+}
+
+TEST(SetOrderTest, testNthRank) {
+  s21::Set<int> s21_set;
+  std::vector<int> sorted;
+  for (int i = 0; i < 300; ++i) {
+    int value = (i * 37) % 300 * 2;
+    s21_set.insert(value);
+  }
+  for (int i = 0; i < 600; i += 14) s21_set.erase(s21_set.find(i));
+  for (int i = 0; i < 600; i += 2) {
+    if (i % 14) sorted.push_back(i);
+  }
+  ASSERT_EQ(s21_set.size(), sorted.size());
+  for (std::size_t k = 0; k < sorted.size(); ++k) {
+    EXPECT_EQ(*s21_set.nth(k), sorted[k]);
+    EXPECT_EQ(s21_set.rank(sorted[k]), k);
+    EXPECT_EQ(s21_set.rank(sorted[k] + 1), k + 1);
+  }
+  EXPECT_TRUE(s21_set.nth(sorted.size()) == s21_set.end());
+  EXPECT_EQ(s21_set.count_range(100, 200), 43);
+  EXPECT_EQ(s21_set.count_range(200, 100), 0);
+  EXPECT_EQ(s21_set.count_range(-5, 1000), sorted.size());
+}
+
+TEST(SetCopyTest, testLargeCopy) {
+  std::vector<int> values(200000);
+  for (std::size_t i = 0; i < values.size(); ++i) values[i] = i;
+  s21::Set<int> s21_set;
+  for (int value : values) s21_set.insert(s21_set.end(), value);
+  s21::Set<int> s21_copy(s21_set);
+  for (int i = 0; i < 200000; i += 3) s21_copy.erase(s21_copy.find(i));
+  EXPECT_EQ(s21_set.size(), values.size());
+  EXPECT_TRUE(std::equal(values.begin(), values.end(), s21_set.begin()));
+  EXPECT_EQ(s21_copy.size(), 133333);
+  EXPECT_EQ(*s21_copy.nth(2), 4);
+  s21_copy.clear();
+  EXPECT_TRUE(s21_copy.empty());
+}
+
+struct ThrowOnCopy {
+  static int copies_left;
+  int key = 0;
+
+  ThrowOnCopy() {}
+  explicit ThrowOnCopy(int k) : key(k) {}
+  ThrowOnCopy(const ThrowOnCopy &other) : key(other.key) {
+    if (copies_left-- == 0) throw std::runtime_error("copy");
+  }
+  bool operator<(const ThrowOnCopy &other) const { return key < other.key; }
+};
+
+int ThrowOnCopy::copies_left = -1;
+
+TEST(SetCopyTest, testThrowingCopy) {
+  s21::Set<ThrowOnCopy> s21_set;
+  for (int i = 0; i < 100; ++i) s21_set.emplace(i);
+  ThrowOnCopy::copies_left = 50;
+  EXPECT_THROW(s21::Set<ThrowOnCopy> s21_copy(s21_set), std::runtime_error);
+  ThrowOnCopy::copies_left = -1;
+  EXPECT_EQ(s21_set.size(), 100);
+}
+
+TEST(SetCopyTest, testThrowingMergeKeepsBothSets) {
+  using PoolSet = s21::Set<ThrowOnCopy, std::less<ThrowOnCopy>,
+                           s21::PoolAllocator<ThrowOnCopy>>;
+  PoolSet s21_first;
+  PoolSet s21_second;
+  for (int i = 0; i < 100; ++i) {
+    s21_first.emplace(i * 2);
+    s21_second.emplace(i * 3);
+  }
+  ThrowOnCopy::copies_left = 20;
+  EXPECT_THROW(s21_first.merge(s21_second), std::runtime_error);
+  ThrowOnCopy::copies_left = 20;
+  EXPECT_THROW(s21_first.merge(s21_second, s21::Parallel(4)),
+               std::runtime_error);
+  PoolSet s21_high;
+  s21_high.emplace(1000);
+  ThrowOnCopy::copies_left = 0;
+  EXPECT_THROW(s21_first.join(s21_high), std::runtime_error);
+  ThrowOnCopy::copies_left = -1;
+  EXPECT_EQ(s21_first.size(), 100);
+  EXPECT_EQ(s21_second.size(), 100);
+  EXPECT_EQ(s21_high.size(), 1);
+  EXPECT_EQ(s21_second.nth(99)->key, 297);
+
+  s21_first.merge(s21_second);
+  EXPECT_EQ(s21_first.size(), 166);
+  EXPECT_EQ(s21_second.size(), 34);
+  s21_first.join(s21_high);
+  EXPECT_EQ((--s21_first.end())->key, 1000);
+}
+
+TEST(SetCopyTest, testMergeSmallIntoLarge) {
+  s21::Set<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 10000; ++i) {
+    s21_set.insert(s21_set.end(), i * 2);
+    std_set.insert(i * 2);
+  }
+  s21::Set<int> s21_other{-1, 7, 8, 30001};
+  std::set<int> std_other{-1, 7, 8, 30001};
+  s21_set.merge(s21_other);
+  std_set.merge(std_other);
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+  ASSERT_EQ(s21_other.size(), 1);
+  EXPECT_EQ(*s21_other.begin(), 8);
+  EXPECT_EQ(*s21_set.nth(1), 0);
+  EXPECT_EQ(s21_set.rank(30001), 10002);
+
+  using PoolSet = s21::Set<ThrowOnCopy, std::less<ThrowOnCopy>,
+                           s21::PoolAllocator<ThrowOnCopy>>;
+  PoolSet s21_large;
+  PoolSet s21_small;
+  for (int i = 0; i < 1000; ++i) s21_large.emplace(i * 2);
+  for (int i = 0; i < 3; ++i) s21_small.emplace(i * 2 + 1);
+  ThrowOnCopy::copies_left = 1;
+  EXPECT_THROW(s21_large.merge(s21_small), std::runtime_error);
+  ThrowOnCopy::copies_left = -1;
+  EXPECT_EQ(s21_large.size(), 1001);
+  EXPECT_EQ(s21_small.size(), 2);
+  s21_large.merge(s21_small);
+  EXPECT_EQ(s21_large.size(), 1003);
+  EXPECT_TRUE(s21_small.empty());
+  EXPECT_EQ(s21_large.nth(5)->key, 5);
+}
+
+TEST(SetIteratorTest, testPlainPointer) {
+  using Iter = s21::Set<std::string>::iterator;
+  using ConstIter = s21::Set<std::string>::const_iterator;
+  static_assert(std::is_trivially_copyable_v<Iter>);
+  static_assert(std::is_trivially_copyable_v<ConstIter>);
+  static_assert(std::is_same_v<decltype(*Iter()), const std::string &>);
+  EXPECT_TRUE(Iter() == Iter());
+
+  s21::Set<std::string> s21_set{"b", "a", "c"};
+  Iter iter = s21_set.begin();
+  iter = s21_set.find("c");
+  EXPECT_EQ(iter->size(), 1);
+  EXPECT_TRUE(iter != s21_set.begin());
+  EXPECT_TRUE(++iter == s21_set.end());
+}
+
+TEST(SetThreadedTest, testMatchesSet) {
+  using ThreadedSet =
+      s21::Set<int, std::less<int>, std::allocator<int>, s21::ThreadedTree<int>>;
+  ThreadedSet s21_set{5, 1, 9};
+  std::set<int> std_set{5, 1, 9};
+  for (int i = 0; i < 500; ++i) {
+    int value = i * 31 % 257;
+    if (i % 3 == 0) {
+      auto iter = s21_set.find(value);
+      if (iter != s21_set.end()) s21_set.erase(iter);
+      std_set.erase(value);
+    } else {
+      s21_set.insert(value);
+      std_set.insert(value);
+    }
+  }
+  s21_set.insert(s21_set.end(), 1000);
+  std_set.insert(1000);
+  auto node = s21_set.extract(9);
+  s21_set.insert(std::move(node));
+
+  ThreadedSet s21_copy(s21_set);
+  ASSERT_EQ(s21_copy.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_copy.begin()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_set.end())));
+
+  ThreadedSet s21_other{-1, 2000, 9};
+  s21_set.merge(s21_other);
+  std_set.insert({-1, 2000, 9});
+  EXPECT_EQ(*s21_set.begin(), -1);
+  EXPECT_EQ(*--s21_set.end(), 2000);
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+}
+
+TEST(SetBTreeTest, testMatchesSet) {
+  using SmallNodeSet =
+      s21::Set<int, std::less<int>, std::allocator<int>,
+               s21::BPlusTree<int, std::less<int>, std::allocator<int>, 64>>;
+  SmallNodeSet s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 3000; ++i) {
+    int value = i * 37 % 1009;
+    if (i % 3 == 2) {
+      auto iter = s21_set.find(value);
+      EXPECT_EQ(iter == s21_set.end(), std_set.count(value) == 0);
+      if (iter != s21_set.end()) s21_set.erase(iter);
+      std_set.erase(value);
+    } else {
+      EXPECT_EQ(s21_set.insert(value).second, std_set.insert(value).second);
+    }
+  }
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_set.end())));
+
+  SmallNodeSet s21_copy(s21_set);
+  auto node = s21_copy.extract(*s21_copy.begin());
+  EXPECT_EQ(node.value(), *std_set.begin());
+  EXPECT_TRUE(s21_copy.insert(std::move(node)).inserted);
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_copy.begin()));
+
+  while (!s21_set.empty()) s21_set.erase(s21_set.begin());
+  EXPECT_TRUE(s21_set.begin() == s21_set.end());
+}
+
+TEST(SetBTreeTest, testSortedBuildAndMerge) {
+  std::vector<int> values;
+  for (int i = 0; i < 1000; ++i) values.push_back(i * 2);
+  s21::BTreeSet<int> s21_set(values.begin(), values.end());
+  s21::BTreeSet<int> s21_other{1, 2, 3, 2001};
+  s21_set.merge(s21_other);
+  EXPECT_EQ(s21_set.size(), 1003);
+  ASSERT_EQ(s21_other.size(), 1);
+  EXPECT_EQ(*s21_other.begin(), 2);
+  EXPECT_TRUE(std::is_sorted(s21_set.begin(), s21_set.end()));
+  EXPECT_EQ(*s21_set.find(2001), 2001);
+  EXPECT_TRUE(s21_set.contains(1998));
+  EXPECT_FALSE(s21_set.contains(1999));
+  for (int i = 0; i < 2000; i += 2) s21_set.erase(s21_set.find(i));
+  EXPECT_EQ(s21_set.size(), 3);
+  EXPECT_EQ(*s21_set.begin(), 1);
+}
+
+// Throws from the copy or move after the first copies_left ones; a move
+// leaves -1 behind.
+struct ThrowOnMove {
+  static int copies_left;
+  int key = 0;
+
+  ThrowOnMove() {}
+  explicit ThrowOnMove(int k) : key(k) {}
+  ThrowOnMove(const ThrowOnMove &other) : key(other.key) {
+    if (copies_left-- == 0) throw std::runtime_error("copy");
+  }
+  ThrowOnMove(ThrowOnMove &&other) : key(other.key) {
+    if (copies_left-- == 0) throw std::runtime_error("move");
+    other.key = -1;
+  }
+  bool operator<(const ThrowOnMove &other) const { return key < other.key; }
+};
+
+int ThrowOnMove::copies_left = -1;
+
+TEST(SetBTreeTest, testThrowingMergeKeepsBothSets) {
+  s21::BTreeSet<ThrowOnMove> s21_first;
+  s21::BTreeSet<ThrowOnMove> s21_second;
+  for (int i = 0; i < 100; ++i) {
+    s21_first.emplace(i * 2);
+    s21_second.emplace(i * 3);
+  }
+  ThrowOnMove::copies_left = 49;
+  EXPECT_THROW(s21_first.merge(s21_second), std::runtime_error);
+  ThrowOnMove::copies_left = -1;
+  ASSERT_EQ(s21_first.size(), 100);
+  ASSERT_EQ(s21_second.size(), 100);
+  int i = 0;
+  for (const ThrowOnMove &value : s21_first) EXPECT_EQ(value.key, 2 * i++);
+  i = 0;
+  for (const ThrowOnMove &value : s21_second) EXPECT_EQ(value.key, 3 * i++);
+
+  s21_first.merge(s21_second);
+  EXPECT_EQ(s21_first.size(), 166);
+  EXPECT_EQ(s21_second.size(), 34);
+  EXPECT_EQ((--s21_first.end())->key, 297);
+}
+
+TEST(SetFrozenTest, testMatchesSet) {
+  for (int size = 0; size < 70; ++size) {
+    s21::Set<int> s21_set;
+    std::set<int> std_set;
+    for (int i = 0; i < size; ++i) {
+      s21_set.insert(i * 7 % 101 * 2);
+      std_set.insert(i * 7 % 101 * 2);
+    }
+    auto frozen = s21_set.freeze();
+    ASSERT_EQ(frozen.size(), std_set.size());
+    EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), frozen.begin(),
+                           frozen.end()));
+    EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                           std::make_reverse_iterator(frozen.end())));
+    for (int key = -1; key < 204; ++key) {
+      auto lower = frozen.lower_bound(key);
+      auto upper = frozen.upper_bound(key);
+      auto std_lower = std_set.lower_bound(key);
+      auto std_upper = std_set.upper_bound(key);
+      ASSERT_EQ(lower == frozen.end(), std_lower == std_set.end());
+      ASSERT_EQ(upper == frozen.end(), std_upper == std_set.end());
+      if (std_lower != std_set.end()) {
+        EXPECT_EQ(*lower, *std_lower);
+      }
+      if (std_upper != std_set.end()) {
+        EXPECT_EQ(*upper, *std_upper);
+      }
+      EXPECT_EQ(frozen.contains(key), std_set.count(key) == 1);
+      EXPECT_EQ(frozen.find(key) != frozen.end(), std_set.count(key) == 1);
+    }
+  }
+}
+
+TEST(SetFrozenTest, testFromUnsortedRange) {
+  std::vector<std::string> words{"pear", "apple", "fig", "apple", "kiwi"};
+  s21::FrozenSet<std::string> frozen(words.begin(), words.end());
+  EXPECT_EQ(frozen.size(), 4);
+  EXPECT_EQ(*frozen.begin(), "apple");
+  EXPECT_EQ(*--frozen.end(), "pear");
+  EXPECT_EQ(*frozen.find("fig"), "fig");
+  EXPECT_FALSE(frozen.contains("plum"));
+  s21::FrozenSet<std::string> copy(frozen);
+  EXPECT_TRUE(std::equal(copy.begin(), copy.end(), frozen.begin()));
+  s21::FrozenSet<std::string> empty;
+  EXPECT_TRUE(empty.begin() == empty.end());
+  EXPECT_TRUE(empty.find("fig") == empty.end());
+}
+
+TEST(SetPrefetchTest, testMatchesSet) {
+  using PrefetchSet = s21::Set<
+      int, std::less<int>, std::allocator<int>,
+      s21::BinaryTree<int, std::less<int>, std::allocator<int>, false,
+                      s21::PrefetchChildren>>;
+  using PrefetchThreadedSet = s21::Set<
+      int, std::less<int>, std::allocator<int>,
+      s21::BinaryTree<int, std::less<int>, std::allocator<int>, true,
+                      s21::PrefetchChildren>>;
+  PrefetchSet s21_set;
+  PrefetchThreadedSet s21_threaded;
+  std::set<int> std_set;
+  for (int i = 0; i < 1000; ++i) {
+    int value = i * 61 % 499;
+    s21_set.insert(value);
+    s21_threaded.insert(value);
+    std_set.insert(value);
+  }
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_threaded.end())));
+  for (int key = -1; key < 501; ++key) {
+    EXPECT_EQ(s21_set.contains(key), std_set.count(key) == 1);
+    EXPECT_EQ(s21_threaded.find(key) != s21_threaded.end(),
+              std_set.count(key) == 1);
+  }
+}
+
+TEST(SetPersistentTest, testSnapshots) {
+  s21::PersistentSet<int> s21_set;
+  std::set<int> std_set;
+  std::vector<std::pair<s21::PersistentSet<int>, std::set<int>>> snapshots;
+  for (int i = 0; i < 3000; ++i) {
+    int value = i * 37 % 701;
+    if (i % 3 == 2) {
+      auto iter = s21_set.find(value);
+      if (iter != s21_set.end()) s21_set.erase(iter);
+      std_set.erase(value);
+    } else {
+      EXPECT_EQ(s21_set.insert(value).second, std_set.insert(value).second);
+    }
+    if (i % 500 == 0) snapshots.emplace_back(s21_set.snapshot(), std_set);
+  }
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin(),
+                         s21_set.end()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_set.end())));
+  for (auto &[snapshot, expected] : snapshots) {
+    ASSERT_EQ(snapshot.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                           snapshot.begin(), snapshot.end()));
+  }
+  s21::PersistentSet<int> copy(s21_set);
+  copy.clear();
+  EXPECT_EQ(s21_set.size(), std_set.size());
+  auto node = s21_set.extract(*s21_set.begin());
+  EXPECT_EQ(node.value(), *std_set.begin());
+  EXPECT_EQ(snapshots.back().first.size(), snapshots.back().second.size());
+}
+
+TEST(ConcurrentSetTest, testInsertErase) {
+  s21::ConcurrentSet<std::string> s21_set;
+  EXPECT_TRUE(s21_set.empty());
+  EXPECT_TRUE(s21_set.insert("b"));
+  EXPECT_TRUE(s21_set.insert("a"));
+  EXPECT_FALSE(s21_set.insert("a"));
+  auto before = s21_set.snapshot();
+  EXPECT_EQ(s21_set.erase("a"), 1);
+  EXPECT_EQ(s21_set.erase("a"), 0);
+  EXPECT_FALSE(s21_set.contains("a"));
+  EXPECT_TRUE(before.contains("a"));
+  std::string joined;
+  s21_set.update([](auto &items) { items.insert("c"); });
+  s21_set.for_each([&joined](const std::string &key) { joined += key; });
+  EXPECT_EQ(joined, "bc");
+  s21_set.clear();
+  EXPECT_EQ(s21_set.size(), 0);
+  EXPECT_EQ(before.size(), 2);
+}
+
+TEST(SetSkipListTest, testMatchesSet) {
+  s21::SkipListSet<int> s21_set;
+  std::set<int> std_set;
+  for (int i = 0; i < 3000; ++i) {
+    int value = i * 37 % 1009;
+    if (i % 3 == 2) {
+      auto iter = s21_set.find(value);
+      EXPECT_EQ(iter == s21_set.end(), std_set.count(value) == 0);
+      if (iter != s21_set.end()) s21_set.erase(iter);
+      std_set.erase(value);
+    } else {
+      EXPECT_EQ(s21_set.insert(value).second, std_set.insert(value).second);
+    }
+  }
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin(),
+                         s21_set.end()));
+  EXPECT_TRUE(std::equal(std_set.rbegin(), std_set.rend(),
+                         std::make_reverse_iterator(s21_set.end())));
+
+  s21::SkipListSet<int> s21_copy(s21_set);
+  auto node = s21_copy.extract(*s21_copy.begin());
+  EXPECT_EQ(node.value(), *std_set.begin());
+  EXPECT_TRUE(s21_copy.insert(std::move(node)).inserted);
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_copy.begin()));
+  s21::SkipListSet<int> s21_other{-1, 0, 2000};
+  s21_copy.merge(s21_other);
+  EXPECT_EQ(s21_copy.size(), std_set.size() + 3 - std_set.count(0));
+  EXPECT_EQ(s21_other.size(), std_set.count(0));
+
+  while (!s21_set.empty()) s21_set.erase(s21_set.begin());
+  EXPECT_TRUE(s21_set.begin() == s21_set.end());
+}
+
+TEST(SetSkipListTest, testConcurrentInsertErase) {
+  s21::SkipListSet<int> s21_set;
+  std::atomic<int> misses{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&s21_set, &misses, t] {
+      for (int i = 0; i < 2000; ++i) {
+        int value = 1000 + i * 4 + t;
+        s21_set.insert(value);
+        s21_set.insert(i % 100);
+        if (i % 2) s21_set.erase(s21_set.find(value - 4));
+        if (!s21_set.contains(i % 100)) ++misses;
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  EXPECT_EQ(misses, 0);
+  std::set<int> std_set;
+  for (int value = 0; value < 9000; ++value) {
+    if (value < 100 || (value >= 1000 && (value - 1000) / 4 % 2)) {
+      std_set.insert(value);
+    }
+  }
+  ASSERT_EQ(s21_set.size(), std_set.size());
+  EXPECT_TRUE(std::equal(std_set.begin(), std_set.end(), s21_set.begin(),
+                         s21_set.end()));
+}
+
+TEST(SetSkipListTest, testForEachWhileErasing) {
+  s21::SkipListSet<int> s21_set;
+  for (int value = 0; value < 4000; ++value) s21_set.insert(value);
+  std::atomic<bool> done{false};
+  std::atomic<int> unordered{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; ++t) {
+    readers.emplace_back([&] {
+      while (!done) {
+        int prev = -1;
+        s21_set.for_each([&](int value) {
+          if (value <= prev || value >= 4000) ++unordered;
+          prev = value;
+        });
+      }
+    });
+  }
+  std::vector<std::thread> erasers;
+  for (int t = 0; t < 2; ++t) {
+    erasers.emplace_back([&s21_set, t] {
+      for (int round = 0; round < 5; ++round) {
+        for (int value = t; value < 4000; value += 2) {
+          s21_set.erase(s21_set.find(value));
+        }
+        for (int value = t; value < 4000; value += 2) s21_set.insert(value);
+      }
+      for (int value = t; value < 4000; value += 2) {
+        if (value % 3) s21_set.erase(s21_set.find(value));
+      }
+    });
+  }
+  for (auto &thread : erasers) thread.join();
+  done = true;
+  for (auto &thread : readers) thread.join();
+  EXPECT_EQ(unordered, 0);
+  std::vector<int> seen;
+  s21_set.for_each([&seen](int value) { seen.push_back(value); });
+  ASSERT_EQ(seen.size(), 1334u);
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_EQ(seen[i], static_cast<int>(i) * 3);
+  }
+}